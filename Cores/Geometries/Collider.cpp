@@ -68,6 +68,70 @@ bool Collider<Dim>::resolve(const VectorDr &pos, const VectorDr &normal, VectorD
 	return false;
 }
 
+template <int Dim>
+DynamicCollider<Dim>::DynamicCollider(std::unique_ptr<Surface<Dim>> surface, const VectorDr &bodyMinCorner, const VectorDr &bodyLengths, const Motion &motion, const real restitutionCoefficient, const real frictionCoefficient) :
+	Collider<Dim>(restitutionCoefficient, frictionCoefficient),
+	_surface(std::make_unique<TransformedSurface<Dim>>(std::move(surface))),
+	_motion(motion),
+	_bodyMinCorner(bodyMinCorner),
+	_bodyMaxCorner(bodyMinCorner + bodyLengths)
+{
+	setTime(0);
+}
+
+template <int Dim>
+void DynamicCollider<Dim>::setTime(const real time)
+{
+	MatrixDr rotation;
+	VectorDr translation;
+	_motion(time, rotation, translation);
+	_surface->setTransform(rotation, translation);
+	_time = time;
+	_lastDt = 0;
+	_lastRotation = rotation;
+	_lastTranslation = translation;
+}
+
+template <int Dim>
+void DynamicCollider<Dim>::advance(const real dt)
+{
+	_lastRotation = _surface->rotation();
+	_lastTranslation = _surface->translation();
+	_time += dt;
+	_lastDt = dt;
+	MatrixDr rotation;
+	VectorDr translation;
+	_motion(_time, rotation, translation);
+	_surface->setTransform(rotation, translation);
+}
+
+template <int Dim>
+auto DynamicCollider<Dim>::sweptBoundingBox() const->std::pair<VectorDr, VectorDr>
+{
+	VectorDr minCorner, maxCorner, lastMinCorner, lastMaxCorner;
+	boundingBox(_surface->rotation(), _surface->translation(), minCorner, maxCorner);
+	boundingBox(_lastRotation, _lastTranslation, lastMinCorner, lastMaxCorner);
+	return { minCorner.cwiseMin(lastMinCorner), maxCorner.cwiseMax(lastMaxCorner) };
+}
+
+template <int Dim>
+Vector<Dim, real> DynamicCollider<Dim>::velocityAt(const VectorDr &pos) const
+{
+	if (_lastDt <= 0) return VectorDr::Zero();
+	const VectorDr lastPos = _lastRotation * _surface->toBody(pos) + _lastTranslation;
+	return (pos - lastPos) / _lastDt;
+}
+
+template <int Dim>
+void DynamicCollider<Dim>::boundingBox(const MatrixDr &rotation, const VectorDr &translation, VectorDr &minCorner, VectorDr &maxCorner) const
+{
+	// The box of a rotated box is spanned by the absolute values of the rotation.
+	const VectorDr center = rotation * (_bodyMinCorner + _bodyMaxCorner) / 2 + translation;
+	const VectorDr halfLengths = rotation.cwiseAbs() * (_bodyMaxCorner - _bodyMinCorner) / 2;
+	minCorner = center - halfLengths;
+	maxCorner = center + halfLengths;
+}
+
 template class Collider<2>;
 template class Collider<3>;
 
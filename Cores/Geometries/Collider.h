@@ -3,7 +3,9 @@
 #include "Geometries/Surface.h"
 #include "Structures/ParticlesAttribute.h"
 
+#include <functional>
 #include <memory>
+#include <utility>
 
 namespace PhysX {
 
@@ -71,9 +73,54 @@ public:
 	virtual const Surface<Dim> *surface() const override final { return _surface.get(); }
 };
 
+// A rigid collider moving along a scripted trajectory.
+//
+// The surface is given in the body frame, together with a box bounding it there, and the motion maps time to the
+// rotation and translation of the body. The velocity of the collider is that of its material points over the last
+// step, so it is consistent with the displacement seen by the fluid.
 template <int Dim>
 class DynamicCollider : public Collider<Dim>
 {
+	DECLARE_DIM_TYPES(Dim)
+
+public:
+
+	using Motion = std::function<void(const real time, MatrixDr &rotation, VectorDr &translation)>;
+
+protected:
+
+	const std::unique_ptr<TransformedSurface<Dim>> _surface;
+	const Motion _motion;
+	const VectorDr _bodyMinCorner;
+	const VectorDr _bodyMaxCorner;
+
+	real _time = 0;
+	real _lastDt = 0;
+	MatrixDr _lastRotation;
+	VectorDr _lastTranslation;
+
+public:
+
+	DynamicCollider(std::unique_ptr<Surface<Dim>> surface, const VectorDr &bodyMinCorner, const VectorDr &bodyLengths, const Motion &motion, const real restitutionCoefficient = 0, const real frictionCoefficient = 0);
+
+	DynamicCollider(const DynamicCollider &rhs) = delete;
+	DynamicCollider &operator=(const DynamicCollider &rhs) = delete;
+	virtual ~DynamicCollider() = default;
+
+	real time() const { return _time; }
+	void setTime(const real time);
+	void advance(const real dt);
+
+	// Returns the world-space box containing the collider both before and after the last step.
+	std::pair<VectorDr, VectorDr> sweptBoundingBox() const;
+
+	virtual VectorDr velocityAt(const VectorDr &pos) const override;
+	virtual Surface<Dim> *surface() override final { return _surface.get(); }
+	virtual const Surface<Dim> *surface() const override final { return _surface.get(); }
+
+protected:
+
+	void boundingBox(const MatrixDr &rotation, const VectorDr &translation, VectorDr &minCorner, VectorDr &maxCorner) const;
 };
 
 }
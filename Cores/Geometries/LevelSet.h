@@ -29,6 +29,8 @@ public:
 	GridBasedScalarField<Dim> &signedDistanceField() { return _signedDistanceField; }
 	const GridBasedScalarField<Dim> &signedDistanceField() const { return _signedDistanceField; }
 
+	real value(const VectorDi &coord) const { return _signedDistanceField[coord]; }
+
 	virtual VectorDr closestNormal(const VectorDr &pos) const { return (_signedDistanceField.gradient(pos)).normalized(); }
 	virtual real signedDistance(const VectorDr &pos) const { return _signedDistanceField(pos); }
 
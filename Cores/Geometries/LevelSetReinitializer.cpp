@@ -115,10 +115,148 @@ real PhysX::FastMarchingReinitializer<Dim>::solveQuadratic(real p0, real p1, rea
 	else return (p0 + p1 + p2 + std::sqrt((p0 + p1 + p2) * (p0 + p1 + p2) - 3 * (p0 * p0 + p1 * p1 + p2 * p2 - dx * dx))) / 3;
 }
 
+template <int Dim>
+FastIterativeReinitializer<Dim>::FastIterativeReinitializer(const Grid<Dim> *const grid) :
+	_tent(grid),
+	_fixed(grid),
+	_active(grid)
+{ }
+
+template <int Dim>
+void FastIterativeReinitializer<Dim>::reinitialize(LevelSet<Dim> &levelSet, const int maxSteps)
+{
+	auto &phi = levelSet.signedDistanceField();
+	const real bandWidth = maxSteps * phi.spacing();
+	_tent.setConstant(bandWidth > 0 ? bandWidth : std::numeric_limits<real>::infinity());
+	_fixed.setZero();
+	_active.setZero();
+	initInterface(phi);
+	performFastIterations();
+	phi.parallelForEach([&](const VectorDi &coord) {
+		phi[coord] = Surface<Dim>::sign(phi[coord]) * _tent[coord];
+	});
+}
+
+template <int Dim>
+void FastIterativeReinitializer<Dim>::initInterface(const GridBasedScalarField<Dim> &phi)
+{
+	phi.parallelForEach([&](const VectorDi &coord) {
+		VectorDr tempPhi = VectorDr::Ones() * std::numeric_limits<real>::infinity();
+		for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+			const VectorDi nbCoord = Grid<Dim>::neighbor(coord, i);
+			if (phi.isValid(nbCoord) && Surface<Dim>::isInterface(phi[coord], phi[nbCoord])) {
+				const int axis = Grid<Dim>::neighborAxis(i);
+				tempPhi[axis] = std::min(tempPhi[axis], Surface<Dim>::theta(phi[coord], phi[nbCoord]) * phi.spacing());
+			}
+		}
+		if (tempPhi.array().isFinite().any()) {
+			_tent[coord] = real(1) / tempPhi.cwiseInverse().norm();
+			_fixed[coord] = true;
+		}
+	});
+	_activeIndices.clear();
+	phi.forEach([&](const VectorDi &coord) {
+		if (_fixed[coord]) return;
+		for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+			const VectorDi nbCoord = Grid<Dim>::neighbor(coord, i);
+			if (phi.isValid(nbCoord) && _fixed[nbCoord]) {
+				_active[coord] = true;
+				_activeIndices.push_back(int(phi.index(coord)));
+				break;
+			}
+		}
+	});
+}
+
+template <int Dim>
+void FastIterativeReinitializer<Dim>::performFastIterations()
+{
+	// Each iteration updates all the active points at once, so that the result does not depend on the scheduling.
+	// A point leaves the active list when it converges, and brings in the neighbors that it is able to improve.
+	constexpr int stride = Grid<Dim>::numberOfNeighbors() + 1;
+	const real tolerance = _kTolerance * _tent.spacing();
+	while (!_activeIndices.empty()) {
+		const int cnt = int(_activeIndices.size());
+		_newValues.resize(cnt);
+		_candidates.resize(size_t(cnt) * stride);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < cnt; i++) {
+			const int index = _activeIndices[i];
+			_newValues[i] = std::min(_tent[index], solveEikonalEquation(_tent.coordinate(index)));
+		}
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < cnt; i++) {
+			const int index = _activeIndices[i];
+			_candidates[size_t(i) * stride] = _tent[index] - _newValues[i] > tolerance ? index : -1;
+			_tent[index] = _newValues[i];
+		}
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < cnt; i++) {
+			const VectorDi coord = _tent.coordinate(_activeIndices[i]);
+			for (int j = 0; j < Grid<Dim>::numberOfNeighbors(); j++) {
+				const VectorDi nbCoord = Grid<Dim>::neighbor(coord, j);
+				int &candidate = _candidates[size_t(i) * stride + j + 1];
+				candidate = -1;
+				if (_candidates[size_t(i) * stride] >= 0) continue;
+				if (!_tent.isValid(nbCoord) || _fixed[nbCoord] || _active[nbCoord]) continue;
+				if (solveEikonalEquation(nbCoord) < _tent[nbCoord] - tolerance)
+					candidate = int(_tent.index(nbCoord));
+			}
+		}
+
+		for (int i = 0; i < cnt; i++) {
+			if (_candidates[size_t(i) * stride] < 0)
+				_active[_activeIndices[i]] = false;
+		}
+		_activeIndices.clear();
+		for (int i = 0; i < cnt; i++) {
+			for (int j = 0; j < stride; j++) {
+				const int index = _candidates[size_t(i) * stride + j];
+				if (index < 0) continue;
+				if (!j) _activeIndices.push_back(index);
+				else if (!_active[index]) {
+					_active[index] = true;
+					_activeIndices.push_back(index);
+				}
+			}
+		}
+	}
+}
+
+template <int Dim>
+real FastIterativeReinitializer<Dim>::solveEikonalEquation(const VectorDi &coord) const
+{
+	VectorDr tempPhi = VectorDr::Ones() * std::numeric_limits<real>::infinity();
+	for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+		const VectorDi nbCoord = Grid<Dim>::neighbor(coord, i);
+		if (_tent.isValid(nbCoord)) {
+			const int axis = Grid<Dim>::neighborAxis(i);
+			tempPhi[axis] = std::min(tempPhi[axis], _tent[nbCoord]);
+		}
+	}
+	real newPhi;
+	if constexpr (Dim == 2) newPhi = FastMarchingReinitializer<Dim>::solveQuadratic(tempPhi.x(), tempPhi.y(), _tent.spacing());
+	else newPhi = FastMarchingReinitializer<Dim>::solveQuadratic(tempPhi.x(), tempPhi.y(), tempPhi.z(), _tent.spacing());
+	// A failed solve leaves the point unchanged rather than aborting.
+	return std::isfinite(newPhi) ? newPhi : std::numeric_limits<real>::infinity();
+}
+
 template class LevelSetReinitializer<2>;
 template class LevelSetReinitializer<3>;
 
 template class FastMarchingReinitializer<2>;
 template class FastMarchingReinitializer<3>;
 
+template class FastIterativeReinitializer<2>;
+template class FastIterativeReinitializer<3>;
+
 }
@@ -54,9 +54,46 @@ protected:
 	void updateNeighbors(const VectorDi &coord);
 	real solveEikonalEquation(const VectorDi &coord) const;
 
+public:
+
 	static real solveQuadratic(const real p0, const real dx) { return p0 + dx; }
 	static real solveQuadratic(real p0, real p1, const real dx);
 	static real solveQuadratic(real p0, real p1, real p2, const real dx);
 };
 
+// Fast iterative method [Jeong and Whitaker 2008] with Jacobi updates of the active list, which are run in parallel.
+template <int Dim>
+class FastIterativeReinitializer final : public LevelSetReinitializer<Dim>
+{
+	DECLARE_DIM_TYPES(Dim)
+
+protected:
+
+	static constexpr real _kTolerance = real(1e-6); // relative to the grid spacing
+
+	GridBasedScalarData<Dim> _tent; // tentative signed distance
+	GridBasedData<Dim, uchar> _fixed;
+	GridBasedData<Dim, uchar> _active;
+
+	std::vector<int> _activeIndices;
+	std::vector<real> _newValues;
+	std::vector<int> _candidates;
+
+public:
+
+	FastIterativeReinitializer(const Grid<Dim> *const grid);
+	FastIterativeReinitializer(const FastIterativeReinitializer &rhs) = delete;
+	FastIterativeReinitializer &operator=(const FastIterativeReinitializer &rhs) = delete;
+	virtual ~FastIterativeReinitializer() = default;
+
+	virtual void reinitialize(LevelSet<Dim> &levelSet, const int maxSteps = -1) override;
+
+protected:
+
+	void initInterface(const GridBasedScalarField<Dim> &phi);
+	void performFastIterations();
+
+	real solveEikonalEquation(const VectorDi &coord) const;
+};
+
 }
@@ -0,0 +1,281 @@
+#include "NarrowBandLevelSet.h"
+
+#include "Geometries/LevelSetReinitializer.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <cmath>
+
+namespace PhysX {
+
+template <int Dim>
+NarrowBandLevelSet<Dim>::NarrowBandLevelSet(const Grid<Dim> *const grid, const int bandSteps) :
+	_grid(grid),
+	_tileGrid(grid->spacing() * _kTileLength, (grid->dataSize() + VectorDi::Ones() * (_kTileLength - 1)) / _kTileLength, grid->dataOrigin()),
+	_bandWidth(bandSteps * grid->spacing())
+{
+	clear();
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::clear()
+{
+	_tileSlots.assign(_tileGrid.dataCount(), -1);
+	_tileSigns.assign(_tileGrid.dataCount(), 1);
+	_slotTiles.clear();
+	_values.clear();
+	_tent.clear();
+	_visited.clear();
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::assign(const LevelSet<Dim> &levelSet)
+{
+	const auto &sdf = levelSet.signedDistanceField();
+	clear();
+	_tileGrid.forEach([&](const VectorDi &tileCoord) {
+		const size_t tile = _tileGrid.index(tileCoord);
+		const VectorDi origin = tileCoord * _kTileLength;
+		_tileSigns[tile] = Surface<Dim>::sign(sdf[origin]);
+		for (int local = 0; local < _kTileVolume; local++) {
+			VectorDi coord;
+			if constexpr (Dim == 2) coord = origin + VectorDi(local & (_kTileLength - 1), local >> _kTileBits);
+			else coord = origin + VectorDi(local & (_kTileLength - 1), local >> _kTileBits & (_kTileLength - 1), local >> (_kTileBits << 1));
+			if (sdf.isValid(coord) && std::abs(sdf[coord]) < _bandWidth) {
+				allocateTile(int(tile));
+				break;
+			}
+		}
+	});
+	parallelForEach([&](const VectorDi &coord, real &val) {
+		val = std::clamp(sdf[coord], -_bandWidth, _bandWidth);
+	});
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::rasterize(LevelSet<Dim> &levelSet) const
+{
+	auto &sdf = levelSet.signedDistanceField();
+	sdf.parallelForEach([&](const VectorDi &coord) {
+		sdf[coord] = value(coord);
+	});
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::remap(const std::function<real(const real)> &func)
+{
+	for (size_t tile = 0; tile < _tileSigns.size(); tile++)
+		if (_tileSlots[tile] < 0) _tileSigns[tile] = Surface<Dim>::sign(func(_tileSigns[tile] * _bandWidth));
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < int(_values.size()); i++)
+		_values[i] = std::clamp(func(_values[i]), -_bandWidth, _bandWidth);
+}
+
+template <int Dim>
+real &NarrowBandLevelSet<Dim>::activate(const VectorDi &coord)
+{
+	const size_t tile = _tileGrid.index(tileOf(coord));
+	const int slot = _tileSlots[tile] < 0 ? allocateTile(int(tile)) : _tileSlots[tile];
+	return _values[offsetOf(slot, coord)];
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::forEach(const std::function<void(const VectorDi &, real &)> &func)
+{
+	for (int slot = 0; slot < int(_slotTiles.size()); slot++) {
+		for (int local = 0; local < _kTileVolume; local++) {
+			const VectorDi coord = coordinateOf(slot, local);
+			if (_grid->isValid(coord))
+				func(coord, _values[size_t(slot) * _kTileVolume + local]);
+		}
+	}
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::parallelForEach(const std::function<void(const VectorDi &, real &)> &func)
+{
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int slot = 0; slot < int(_slotTiles.size()); slot++) {
+		for (int local = 0; local < _kTileVolume; local++) {
+			const VectorDi coord = coordinateOf(slot, local);
+			if (_grid->isValid(coord))
+				func(coord, _values[size_t(slot) * _kTileVolume + local]);
+		}
+	}
+}
+
+template <int Dim>
+Vector<Dim, real> NarrowBandLevelSet<Dim>::gradient(const VectorDr &pos) const
+{
+	VectorDr grad = VectorDr::Zero();
+	for (const auto &[coord, weight] : _grid->linearIntrplDataPoints(pos)) {
+		VectorDr acc;
+		for (int i = 0; i < Dim; i++)
+			acc[i] = value(coord + VectorDi::Unit(i)) - value(coord - VectorDi::Unit(i));
+		grad += acc * real(.5) * _grid->invSpacing() * weight;
+	}
+	return grad;
+}
+
+template <int Dim>
+real NarrowBandLevelSet<Dim>::signedDistance(const VectorDr &pos) const
+{
+	real val = 0;
+	for (const auto &[coord, weight] : _grid->linearIntrplDataPoints(pos))
+		val += value(coord) * weight;
+	return val;
+}
+
+template <int Dim>
+real NarrowBandLevelSet<Dim>::curvature(const VectorDr &pos) const
+{
+	const real dx = _grid->spacing();
+	const real invDx = _grid->invSpacing();
+	real acc = 0;
+	for (int i = 0; i < Dim; i++) {
+		acc += closestNormal(pos + VectorDr::Unit(i) * dx / 2)[i] - closestNormal(pos - VectorDr::Unit(i) * dx / 2)[i];
+	}
+	acc *= invDx;
+	return std::abs(acc) < invDx ? acc : (acc < 0 ? -1 : 1) * invDx;
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::reinitialize()
+{
+	_tent.assign(_values.size(), _bandWidth);
+	_visited.assign(_values.size(), 0);
+	initInterface();
+	performFastMarching();
+	parallelForEach([&](const VectorDi &, real &val) {
+		val = Surface<Dim>::sign(val) * _tent[&val - _values.data()];
+	});
+	releaseFarTiles();
+}
+
+template <int Dim>
+int NarrowBandLevelSet<Dim>::allocateTile(const int tile)
+{
+	const int slot = int(_slotTiles.size());
+	_tileSlots[tile] = slot;
+	_slotTiles.push_back(tile);
+	_values.resize(_values.size() + _kTileVolume, _tileSigns[tile] * _bandWidth);
+	if (!_tent.empty()) { // during fast marching
+		_tent.resize(_values.size(), _bandWidth);
+		_visited.resize(_values.size(), 0);
+	}
+	return slot;
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::releaseFarTiles()
+{
+	int newSlotCnt = 0;
+	for (int slot = 0; slot < int(_slotTiles.size()); slot++) {
+		const int tile = _slotTiles[slot];
+		const auto begin = _values.begin() + size_t(slot) * _kTileVolume;
+		const auto end = begin + _kTileVolume;
+		// Data points out of the grid keep the initial values and never enter the band.
+		if (std::any_of(begin, end, [&](const real val) { return std::abs(val) < _bandWidth; })) {
+			if (newSlotCnt != slot)
+				std::copy(begin, end, _values.begin() + size_t(newSlotCnt) * _kTileVolume);
+			_slotTiles[newSlotCnt] = tile;
+			_tileSlots[tile] = newSlotCnt++;
+		}
+		else {
+			_tileSigns[tile] = Surface<Dim>::sign(*begin);
+			_tileSlots[tile] = -1;
+		}
+	}
+	_slotTiles.resize(newSlotCnt);
+	_values.resize(size_t(newSlotCnt) * _kTileVolume);
+	_tent.clear();
+	_visited.clear();
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::initInterface()
+{
+	_intfIndices.clear();
+	forEach([&](const VectorDi &coord, real &val) {
+		VectorDr tempPhi = VectorDr::Ones() * std::numeric_limits<real>::infinity();
+		for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+			const VectorDi nbCoord = Grid<Dim>::neighbor(coord, i);
+			if (!_grid->isValid(nbCoord)) continue;
+			if (const real nbVal = value(nbCoord); Surface<Dim>::isInterface(val, nbVal)) {
+				const int axis = Grid<Dim>::neighborAxis(i);
+				tempPhi[axis] = std::min(tempPhi[axis], Surface<Dim>::theta(val, nbVal) * _grid->spacing());
+			}
+		}
+		if (tempPhi.array().isFinite().any()) {
+			const size_t offset = &val - _values.data();
+			_tent[offset] = real(1) / tempPhi.cwiseInverse().norm();
+			_visited[offset] = true;
+			_intfIndices.push_back(int(_grid->index(coord)));
+		}
+	});
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::performFastMarching()
+{
+	for (const auto index : _intfIndices)
+		updateNeighbors(_grid->coordinate(index));
+	while (!_heap.empty()) {
+		const real val = _heap.top().first;
+		const VectorDi coord = _grid->coordinate(_heap.top().second);
+		_heap.pop();
+		const size_t offset = offsetOf(_tileSlots[_tileGrid.index(tileOf(coord))], coord);
+		if (_tent[offset] != val) continue;
+		_visited[offset] = true;
+		updateNeighbors(coord);
+	}
+}
+
+template <int Dim>
+void NarrowBandLevelSet<Dim>::updateNeighbors(const VectorDi &coord)
+{
+	for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+		const VectorDi nbCoord = Grid<Dim>::neighbor(coord, i);
+		if (!_grid->isValid(nbCoord)) continue;
+		const size_t tile = _tileGrid.index(tileOf(nbCoord));
+		const int slot = _tileSlots[tile];
+		if (slot >= 0 && _visited[offsetOf(slot, nbCoord)]) continue;
+		if (const real temp = solveEikonalEquation(nbCoord); temp < (slot >= 0 ? _tent[offsetOf(slot, nbCoord)] : _bandWidth)) {
+			_tent[offsetOf(slot >= 0 ? slot : allocateTile(int(tile)), nbCoord)] = temp;
+			_heap.push(HeapElement(temp, int(_grid->index(nbCoord))));
+		}
+	}
+}
+
+template <int Dim>
+real NarrowBandLevelSet<Dim>::solveEikonalEquation(const VectorDi &coord) const
+{
+	VectorDr tempPhi = VectorDr::Ones() * std::numeric_limits<real>::infinity();
+	for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+		const VectorDi nbCoord = Grid<Dim>::neighbor(coord, i);
+		if (!_grid->isValid(nbCoord)) continue;
+		const int slot = _tileSlots[_tileGrid.index(tileOf(nbCoord))];
+		if (slot >= 0 && _visited[offsetOf(slot, nbCoord)]) {
+			const int axis = Grid<Dim>::neighborAxis(i);
+			tempPhi[axis] = std::min(tempPhi[axis], _tent[offsetOf(slot, nbCoord)]);
+		}
+	}
+	real newPhi;
+	if constexpr (Dim == 2) newPhi = FastMarchingReinitializer<Dim>::solveQuadratic(tempPhi.x(), tempPhi.y(), _grid->spacing());
+	else newPhi = FastMarchingReinitializer<Dim>::solveQuadratic(tempPhi.x(), tempPhi.y(), tempPhi.z(), _grid->spacing());
+	if (!std::isfinite(newPhi)) {
+		std::cerr << "Error: [NarrowBandLevelSet] failed to solve Eikonal equation." << std::endl;
+		std::exit(-1);
+	}
+	return newPhi;
+}
+
+template class NarrowBandLevelSet<2>;
+template class NarrowBandLevelSet<3>;
+
+}
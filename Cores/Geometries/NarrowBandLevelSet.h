@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Geometries/LevelSet.h"
+
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace PhysX {
+
+// A level set that stores signed distances only in a narrow band around the interface.
+//
+// The grid is partitioned into tiles of 8^Dim data points. Tiles that contain a data point closer than the band width
+// to the interface keep their signed distances, while the other tiles keep nothing but a sign. Values read from the
+// latter are clamped to the band width, which is also what the fast marching reinitializer produces far from the
+// interface. Thus the storage, as well as the cost of advection and reinitialization, scales with the area of the
+// interface instead of the volume of the domain.
+template <int Dim>
+class NarrowBandLevelSet : public ImplicitSurface<Dim>
+{
+	DECLARE_DIM_TYPES(Dim)
+
+	using HeapElement = std::pair<real, int>;
+
+protected:
+
+	static constexpr int _kTileBits = 3;
+	static constexpr int _kTileLength = 1 << _kTileBits;
+	static constexpr int _kTileVolume = MathFunc::pow(_kTileLength, Dim);
+
+	const Grid<Dim> *const _grid;
+	const Grid<Dim> _tileGrid;
+	const real _bandWidth;
+
+	std::vector<int> _tileSlots; // slots of tiles in the band, or -1 otherwise
+	std::vector<signed char> _tileSigns; // signs of tiles out of the band
+	std::vector<int> _slotTiles;
+	std::vector<real> _values;
+
+	// Reinitialization.
+	std::vector<real> _tent;
+	std::vector<uchar> _visited;
+	std::vector<int> _intfIndices;
+	std::priority_queue<HeapElement, std::vector<HeapElement>, std::greater<HeapElement>> _heap;
+
+public:
+
+	NarrowBandLevelSet(const Grid<Dim> *const grid, const int bandSteps);
+
+	NarrowBandLevelSet(const NarrowBandLevelSet &rhs) = default;
+	NarrowBandLevelSet &operator=(const NarrowBandLevelSet &rhs) = delete;
+	virtual ~NarrowBandLevelSet() = default;
+
+	const Grid<Dim> *grid() const { return _grid; }
+	real bandWidth() const { return _bandWidth; }
+	size_t bandTileCount() const { return _slotTiles.size(); }
+	size_t bandDataCount() const { return _values.size(); }
+
+	void clear();
+	void assign(const LevelSet<Dim> &levelSet);
+	void rasterize(LevelSet<Dim> &levelSet) const;
+	// Replaces every value with func of it, clamped to the band width. Tiles out of the band map their sign as a whole.
+	void remap(const std::function<real(const real)> &func);
+
+	real value(const VectorDi &coord) const
+	{
+		const VectorDi clamped = _grid->clamp(coord);
+		const size_t tile = _tileGrid.index(tileOf(clamped));
+		return _tileSlots[tile] < 0 ? _tileSigns[tile] * _bandWidth : _values[offsetOf(_tileSlots[tile], clamped)];
+	}
+
+	// Returns a reference to the value at the given data point, bringing its tile into the band if necessary.
+	real &activate(const VectorDi &coord);
+
+	void forEach(const std::function<void(const VectorDi &, real &)> &func);
+	void parallelForEach(const std::function<void(const VectorDi &, real &)> &func);
+
+	VectorDr gradient(const VectorDr &pos) const;
+	virtual VectorDr closestNormal(const VectorDr &pos) const override { return gradient(pos).normalized(); }
+	virtual real signedDistance(const VectorDr &pos) const override;
+
+	real curvature(const VectorDr &pos) const;
+
+	void reinitialize();
+
+protected:
+
+	static VectorDi tileOf(const VectorDi &coord) { return coord.unaryExpr([](const int x) { return x >> _kTileBits; }); }
+
+	static size_t offsetOf(const int slot, const VectorDi &coord)
+	{
+		const VectorDi local = coord.unaryExpr([](const int x) { return x & (_kTileLength - 1); });
+		if constexpr (Dim == 2) return size_t(slot) * _kTileVolume + (local.x() | local.y() << _kTileBits);
+		else return size_t(slot) * _kTileVolume + (local.x() | (local.y() | local.z() << _kTileBits) << _kTileBits);
+	}
+
+	VectorDi coordinateOf(const int slot, const int local) const
+	{
+		const VectorDi origin = _tileGrid.coordinate(_slotTiles[slot]) * _kTileLength;
+		if constexpr (Dim == 2) return origin + VectorDi(local & (_kTileLength - 1), local >> _kTileBits);
+		else return origin + VectorDi(local & (_kTileLength - 1), local >> _kTileBits & (_kTileLength - 1), local >> (_kTileBits << 1));
+	}
+
+	int allocateTile(const int tile);
+	void releaseFarTiles();
+
+	void initInterface();
+	void performFastMarching();
+	void updateNeighbors(const VectorDi &coord);
+	real solveEikonalEquation(const VectorDi &coord) const;
+};
+
+}
@@ -68,4 +68,35 @@ public:
 	virtual bool isInside(const VectorDr &pos) const override { return Surface<Dim>::isInside(signedDistance(pos)); }
 };
 
+// A surface given in a body frame and placed in the world by a rigid transform x = rotation * X + translation.
+template <int Dim>
+class TransformedSurface : public Surface<Dim>
+{
+	DECLARE_DIM_TYPES(Dim)
+
+protected:
+
+	std::unique_ptr<Surface<Dim>> _surface;
+	MatrixDr _rotation = MatrixDr::Identity();
+	VectorDr _translation = VectorDr::Zero();
+
+public:
+
+	TransformedSurface(std::unique_ptr<Surface<Dim>> surface) : _surface(std::move(surface)) { }
+	virtual ~TransformedSurface() = default;
+
+	const MatrixDr &rotation() const { return _rotation; }
+	const VectorDr &translation() const { return _translation; }
+	void setTransform(const MatrixDr &rotation, const VectorDr &translation) { _rotation = rotation; _translation = translation; }
+
+	VectorDr toBody(const VectorDr &pos) const { return _rotation.transpose() * (pos - _translation); }
+	VectorDr toWorld(const VectorDr &pos) const { return _rotation * pos + _translation; }
+
+	virtual VectorDr closestPosition(const VectorDr &pos) const override { return toWorld(_surface->closestPosition(toBody(pos))); }
+	virtual VectorDr closestNormal(const VectorDr &pos) const override { return _rotation * _surface->closestNormal(toBody(pos)); }
+	virtual real distance(const VectorDr &pos) const override { return _surface->distance(toBody(pos)); }
+	virtual real signedDistance(const VectorDr &pos) const override { return _surface->signedDistance(toBody(pos)); }
+	virtual bool isInside(const VectorDr &pos) const override { return _surface->isInside(toBody(pos)); }
+};
+
 }
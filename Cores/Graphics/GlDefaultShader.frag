@@ -11,6 +11,7 @@ uniform vec4 uDiffuseAlbedo;
 uniform vec3 uFresnelR0;
 uniform float uRoughness;
 uniform uint uEnableColorMap;
+uniform vec2 uHeatRange;
 
 vec3 diffuseColor;
 
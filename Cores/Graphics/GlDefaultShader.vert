@@ -13,6 +13,7 @@ uniform vec4 uDiffuseAlbedo;
 uniform vec3 uFresnelR0;
 uniform float uRoughness;
 uniform uint uEnableColorMap;
+uniform vec2 uHeatRange;
 
 layout (std140, binding = 0) uniform PassConstants
 {
@@ -29,7 +30,7 @@ void main()
 {
 	vertPos = aPos;
 	vertNormal = aNormal;
-	vertHeat = aHeat;
+	vertHeat = (aHeat - uHeatRange.x) / (uHeatRange.y - uHeatRange.x);
 	gl_Position = uProjView * vec4(vertPos, 1.0);
 }
 )"
@@ -38,13 +38,13 @@ public:
 
 	virtual ~MatPointPlasticSoftBody() = default;
 
-	virtual void save(std::ofstream &fout) const override
+	virtual void save(std::ostream &fout) const override
 	{
 		MaterialPointSoftBody<Dim, Model>::save(fout);
 		_plasticJacobians.save(fout);
 	}
 
-	virtual void load(std::ifstream &fin) override
+	virtual void load(std::istream &fin) override
 	{
 		MaterialPointSoftBody<Dim, Model>::load(fin);
 		_plasticJacobians.load(fin);
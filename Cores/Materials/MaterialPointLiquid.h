@@ -32,13 +32,13 @@ public:
 
 	virtual ~MaterialPointLiquid() = default;
 
-	virtual void save(std::ofstream &fout) const override
+	virtual void save(std::ostream &fout) const override
 	{
 		MaterialPointSubstance<Dim>::save(fout);
 		_jacobians.save(fout);
 	}
 
-	virtual void load(std::ifstream &fin) override
+	virtual void load(std::istream &fin) override
 	{
 		MaterialPointSubstance<Dim>::load(fin);
 		_jacobians.load(fin);
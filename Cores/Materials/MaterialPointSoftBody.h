@@ -31,13 +31,13 @@ public:
 
 	virtual ~MaterialPointSoftBody() = default;
 
-	virtual void save(std::ofstream &fout) const override
+	virtual void save(std::ostream &fout) const override
 	{
 		MaterialPointSubstance<Dim>::save(fout);
 		_deformationGradients.save(fout);
 	}
 
-	virtual void load(std::ifstream &fin) override
+	virtual void load(std::istream &fin) override
 	{
 		MaterialPointSubstance<Dim>::load(fin);
 		_deformationGradients.load(fin);
@@ -33,26 +33,19 @@ public:
 	const Vector4f &color() const { return _color; }
 	real density() const { return _density; }
 
-	void write(std::ofstream &fout) const
+	void write(std::ostream &fout) const
 	{
 		IO::writeValue(fout, uint(particles.size()));
-		particles.forEach([&](const int i) {
-			IO::writeValue(fout, particles.positions[i].template cast<float>().eval());
-		});
-		if constexpr (Dim == 3) {
-			particles.forEach([&](const int i) {
-				IO::writeValue(fout, VectorDf::Unit(2).eval());
-			});
-		}
+		IO::writeCast<float>(fout, particles.positions);
 	}
 
-	virtual void save(std::ofstream &fout) const
+	virtual void save(std::ostream &fout) const
 	{
 		IO::writeValue(fout, uint(particles.size()));
 		particles.positions.save(fout);
 	}
 
-	virtual void load(std::ifstream &fin)
+	virtual void load(std::istream &fin)
 	{
 		uint particlesCnt;
 		IO::readValue(fin, particlesCnt);
@@ -13,30 +13,17 @@ void AffineParticleInCellLiquid<Dim>::transferFromGridToParticles()
 	ParticleInCellLiquid<Dim>::transferFromGridToParticles();
 
 	_particles.parallelForEach([&](const int i) {
-		const VectorDr &pos = _particles.positions[i];
-		for (int axis = 0; axis < Dim; axis++) {
-			_particleVelocityDerivatives[axis][i] = VectorDr::Zero();
-			for (const auto [face, gradWeight] : _velocity[axis].grid()->gradientLinearIntrplDataPoints(pos)) {
-				_particleVelocityDerivatives[axis][i] += _velocity[axis][face] * gradWeight;
-			}
-		}
+		for (int axis = 0; axis < Dim; axis++)
+			_particleVelocityDerivatives[axis][i] = velocityDerivative(axis, _particles.positions[i]);
 	});
 }
 
 template <int Dim>
 void AffineParticleInCellLiquid<Dim>::transferFromParticlesToGrid(StaggeredGridBasedScalarData<Dim> &weightSum)
 {
-	_particles.forEach([&](const int i) {
-		const VectorDr &pos = _particles.positions[i];
-		const VectorDr &vel = _particleVelocities[i];
-		for (int axis = 0; axis < Dim; axis++) {
-			const VectorDr gradVelAxis = _particleVelocityDerivatives[axis][i];
-			for (const auto [face, weight] : _velocity[axis].grid()->linearIntrplDataPoints(pos)) {
-				const VectorDr deltaPos = _velocity[axis].position(face) - pos;
-				_velocity[axis][face] += (vel[axis] + gradVelAxis.dot(deltaPos)) * weight;
-				weightSum[axis][face] += weight;
-			}
-		}
+	this->transferFromParticlesToFaces(weightSum, [&](const int i, const int axis, const VectorDi &face) {
+		const VectorDr deltaPos = _velocity[axis].position(face) - _particles.positions[i];
+		return _particleVelocities[i][axis] + _particleVelocityDerivatives[axis][i].dot(deltaPos);
 	});
 }
 
@@ -50,6 +37,36 @@ void AffineParticleInCellLiquid<Dim>::reinitializeParticlesBasedData()
 	}
 }
 
+template <int Dim>
+void AffineParticleInCellLiquid<Dim>::redistributeParticlesBasedData(const std::vector<int> &groups, const int groupsCnt, const std::vector<uchar> &kept)
+{
+	ParticleInCellLiquid<Dim>::redistributeParticlesBasedData(groups, groupsCnt, kept);
+	for (int axis = 0; axis < Dim; axis++)
+		this->redistributeParticlesBasedVectorData(_particleVelocityDerivatives[axis], groups, groupsCnt, kept);
+}
+
+template <int Dim>
+void AffineParticleInCellLiquid<Dim>::remapParticlesBasedData(const std::vector<int> &sources)
+{
+	ParticleInCellLiquid<Dim>::remapParticlesBasedData(sources);
+	for (int axis = 0; axis < Dim; axis++) {
+		ParticlesBasedVectorData<Dim> derivatives(&_particles);
+		_particles.parallelForEach([&](const int i) {
+			derivatives[i] = sources[i] < 0 ? velocityDerivative(axis, _particles.positions[i]) : _particleVelocityDerivatives[axis][sources[i]];
+		});
+		_particleVelocityDerivatives[axis] = std::move(derivatives);
+	}
+}
+
+template <int Dim>
+Vector<Dim, real> AffineParticleInCellLiquid<Dim>::velocityDerivative(const int axis, const VectorDr &pos) const
+{
+	VectorDr grad = VectorDr::Zero();
+	for (const auto [face, gradWeight] : _velocity[axis].grid()->gradientLinearIntrplDataPoints(pos))
+		grad += _velocity[axis][face] * gradWeight;
+	return grad;
+}
+
 template class AffineParticleInCellLiquid<2>;
 template class AffineParticleInCellLiquid<3>;
 
@@ -34,6 +34,10 @@ protected:
 	virtual void transferFromParticlesToGrid(StaggeredGridBasedScalarData<Dim> &weightSum) override;
 
 	virtual void reinitializeParticlesBasedData() override;
+	virtual void redistributeParticlesBasedData(const std::vector<int> &groups, const int groupsCnt, const std::vector<uchar> &kept) override;
+	virtual void remapParticlesBasedData(const std::vector<int> &sources) override;
+
+	VectorDr velocityDerivative(const int axis, const VectorDr &pos) const;
 };
 
 }
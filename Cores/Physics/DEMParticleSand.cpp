@@ -12,7 +12,9 @@ namespace PhysX {
             node["primitive_type"]             = "point_list";
             node["material"]["diffuse_albedo"] = (Vector4f(52, 108, 156, 255) / 255).eval(); // Haijun Blue
             node["indexed"]                    = false;
+            node["constant_normal"]            = Vector3f::Unit(2).eval();
             node["color_map"]["enabled"]       = true;
+            if (_particlesCodec) _particlesCodec->writeDescription(node);
             root["objects"].push_back(node);
         }
         { // Description of particles.
@@ -22,55 +24,51 @@ namespace PhysX {
             node["primitive_type"]             = "point_list";
             node["material"]["diffuse_albedo"] = (Vector4f(52, 108, 156, 255) / 255).eval(); // Haijun Blue
             node["indexed"]                    = false;
+            node["constant_normal"]            = Vector3f::Unit(2).eval();
             node["color_map"]["enabled"]       = false;
+            if (_boundaryParticlesCodec) _boundaryParticlesCodec->writeDescription(node);
             root["objects"].push_back(node);
         }
     }
 
     template<int Dim>
-    void DEMParticleSand<Dim>::writeFrame(const std::string & frameDir, const bool staticDraw) const {
+    void DEMParticleSand<Dim>::writeFrame(FrameBuffer & frame, const bool staticDraw) const {
         { // Write particles.
-            std::ofstream fout(frameDir + "/particles.mesh", std::ios::binary);
+            auto & fout = frame.open("particles.mesh");
             IO::writeValue(fout, uint(_particles.size()));
-            _particles.forEach(
-                [&](const int i) { IO::writeValue(fout, _particles.positions[i].template cast<float>().eval()); });
-            if constexpr (Dim == 3) {
-                _particles.forEach([&](const int i) { IO::writeValue(fout, VectorDf::Unit(2).eval()); });
-            }
-            _particles.forEach([&](const int i) { IO::writeValue(fout, float(_particles.velocities[i].norm())); });
+            if (_particlesCodec) _particlesCodec->encode(fout, _particles.positions);
+            else IO::writeCast<float>(fout, _particles.positions);
+            frame.writeHeats(
+                fout, _particles.size(), [&](const int i) { return float(_particles.velocities[i].norm()); });
         }
         { // Write particles.
-            std::ofstream fout(frameDir + "/boundary_particles.mesh", std::ios::binary);
+            auto & fout = frame.open("boundary_particles.mesh");
             IO::writeValue(fout, uint(_boundary_particles.size()));
-            _boundary_particles.forEach([&](const int i) {
-                IO::writeValue(fout, _boundary_particles.positions[i].template cast<float>().eval());
-            });
-            if constexpr (Dim == 3) {
-                _boundary_particles.forEach([&](const int i) { IO::writeValue(fout, VectorDf::Unit(2).eval()); });
-            }
+            if (_boundaryParticlesCodec) _boundaryParticlesCodec->encode(fout, _boundary_particles.positions);
+            else IO::writeCast<float>(fout, _boundary_particles.positions);
             //_particles.forEach([&](const int i) { IO::writeValue(fout, float(_velocities[i].norm())); });
         }
     }
 
-    template<int Dim> void DEMParticleSand<Dim>::saveFrame(const std::string & frameDir) const {
+    template<int Dim> void DEMParticleSand<Dim>::saveFrame(FrameBuffer & frame) const {
         { // Save particles.
-            std::ofstream fout(frameDir + "/particles.sav", std::ios::binary);
+            auto & fout = frame.open("particles.sav");
             _particles.positions.save(fout);
         }
         { // save velocities.
-            std::ofstream fout(frameDir + "/velocities.sav", std::ios::binary);
+            auto & fout = frame.open("velocities.sav");
             _particles.velocities.save(fout);
         }
     }
 
-    template<int Dim> void DEMParticleSand<Dim>::loadFrame(const std::string & frameDir) {
+    template<int Dim> void DEMParticleSand<Dim>::loadFrame(const ArchivedFrame & frame) {
         { // Load particles.
-            std::ifstream fin(frameDir + "/particles.sav", std::ios::binary);
+            auto fin = frame.open("particles.sav");
             _particles.positions.load(fin);
         }
         reinitializeParticlesBasedData();
         { // Load velocities.
-            std::ifstream fin(frameDir + "/velocities.sav", std::ios::binary);
+            auto fin = frame.open("velocities.sav");
             _particles.velocities.load(fin);
         }
     }
@@ -174,6 +172,16 @@ namespace PhysX {
         }
     } 
 
+    template<int Dim>
+    void DEMParticleSand<Dim>::enableQuantizedOutput(
+        const VectorDr & lower, const VectorDr & upper, const real errorBound) {
+        Vector3f lower3f = Vector3f::Zero(), upper3f = Vector3f::Zero();
+        lower3f.head<Dim>()     = lower.template cast<float>();
+        upper3f.head<Dim>()     = upper.template cast<float>();
+        _particlesCodec         = std::make_unique<QuantizedPositionsCodec>(Dim, lower3f, upper3f, float(errorBound));
+        _boundaryParticlesCodec = std::make_unique<QuantizedPositionsCodec>(Dim, lower3f, upper3f, float(errorBound));
+    }
+
     template class DEMParticleSand<2>;
     template class DEMParticleSand<3>;
 
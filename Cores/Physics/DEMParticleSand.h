@@ -6,8 +6,11 @@
 #include "Structures/ParticlesBasedVectorField.h"
 #include "Structures/StaggeredGrid.h"
 #include "Structures/DEMParticle.h"
+#include "Utilities/QuantizedPositionsCodec.h"
 #include "Utilities/Shapes.h"
 
+#include <memory>
+
 namespace PhysX {
 
     template<int Dim> class DEMParticleSand : public Simulation {
@@ -26,6 +29,10 @@ namespace PhysX {
 
         bool _enableGravity = true;
 
+        // Codecs of positions in .mesh files if quantized, which keep the last frames written.
+        mutable std::unique_ptr<QuantizedPositionsCodec> _particlesCodec;
+        mutable std::unique_ptr<QuantizedPositionsCodec> _boundaryParticlesCodec;
+
     public:
         DEMParticleSand(const real particleRadius):
             _particles(particleRadius), _boundary_particles(particleRadius){}
@@ -40,15 +47,16 @@ namespace PhysX {
 
         virtual int  dimension() const override { return Dim; }
         virtual void writeDescription(YAML::Node & root) const override;
-        virtual void writeFrame(const std::string & frameDir, const bool staticDraw) const override;
-        virtual void saveFrame(const std::string & frameDir) const override;
-        virtual void loadFrame(const std::string & frameDir) override;
+        virtual void writeFrame(FrameBuffer & frame, const bool staticDraw) const override;
+        virtual void saveFrame(FrameBuffer & frame) const override;
+        virtual void loadFrame(const ArchivedFrame & frame) override;
 
         virtual void initialize() override;
         virtual void advance(const real dt) override;
 
         void generateSurface(const Surface<Dim> & surface);
         void addShape(const Shapes<Dim> & shape);
+        void enableQuantizedOutput(const VectorDr & lower, const VectorDr & upper, const real errorBound);
 
     protected:
         virtual void reinitializeParticlesBasedData();
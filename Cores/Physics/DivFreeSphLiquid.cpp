@@ -0,0 +1,151 @@
+#include "DivFreeSphLiquid.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace PhysX {
+
+    template<int Dim> real DivFreeSphLiquid<Dim>::getTimeStep(const uint frameRate, const real stepRate) const {
+        return std::min(SmthParticleHydrodLiquid<Dim>::getTimeStep(frameRate, stepRate), _kMaxTimeStep);
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::advance(const real dt) {
+        updateVelocity(dt);
+        correctDensity(dt);
+        moveParticles(dt);
+        correctVelocity(dt);
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::reinitializeParticlesBasedData() {
+        SmthParticleHydrodLiquid<Dim>::reinitializeParticlesBasedData();
+        _factors.resize(&_particles);
+        _densityStiffnesses.resize(&_particles);
+        _densityStiffnesses.setZero();
+        _divergenceStiffnesses.resize(&_particles);
+        _divergenceStiffnesses.setZero();
+        _stiffnesses.resize(&_particles);
+
+        _particles.resetNearbySearcher();
+        _particles.computeDensities();
+        computeFactors();
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::moveParticles(const real dt) {
+        SmthParticleHydrodLiquid<Dim>::moveParticles(dt);
+        computeFactors();
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::updateVelocity(const real dt) {
+        applyExternalForces(dt);
+        applyViscosityForce(dt);
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::correctDensity(const real dt) {
+        // Stiffnesses are stored multiplied by dt^2 so that they carry over steps of different sizes.
+        warmStart(_densityStiffnesses, 1 / dt);
+
+        for (int iter = 0; iter < _kMaxIters; iter++) {
+            resolveCollisions(dt);
+            _particles.parallelForEach([&](const int i) {
+                _stiffnesses[i] = _particles.densities[i] + computeDensityChangeRate(i) * dt - _targetDensity;
+            });
+            if (iter >= _kMinDensityIters && sumOfCompression() <= _kDensityErrorRatio * _targetDensity * _particles.size())
+                break;
+            updateStiffnesses(_densityStiffnesses);
+            applyStiffnesses(_stiffnesses, 1 / dt);
+        }
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::correctVelocity(const real dt) {
+        // Stiffnesses are stored multiplied by dt.
+        warmStart(_divergenceStiffnesses, 1);
+
+        for (int iter = 0; iter < _kMaxIters; iter++) {
+            _particles.parallelForEach([&](const int i) { _stiffnesses[i] = computeDensityChangeRate(i); });
+            if (sumOfCompression() * dt <= _kDivergenceErrorRatio * _targetDensity * _particles.size()) break;
+            updateStiffnesses(_divergenceStiffnesses);
+            applyStiffnesses(_stiffnesses, 1);
+        }
+
+        _particles.parallelForEach([&](const int i) {
+            _pressures[i] = (_divergenceStiffnesses[i] / dt + _densityStiffnesses[i] / (dt * dt)) * _particles.densities[i];
+        });
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::resolveCollisions(const real dt) {
+        // Colliders are not sampled by particles, so velocities heading into them are resolved at predicted positions.
+        // Otherwise the solver would relieve compression by pushing particles into colliders, which then stop them.
+        _particles.parallelForEach([&](const int i) {
+            const VectorDr predPos = _particles.positions[i] + _velocities[i] * dt;
+            for (const auto & collider : _colliders)
+                if (collider->detect(predPos, _particles.radius())) collider->resolve(predPos, _velocities[i]);
+        });
+    }
+
+    template<int Dim> real DivFreeSphLiquid<Dim>::sumOfCompression() const {
+        real sum = 0;
+        _particles.forEach([&](const int i) { sum += std::max(_stiffnesses[i], real(0)); });
+        return sum;
+    }
+
+    template<int Dim>
+    void DivFreeSphLiquid<Dim>::warmStart(ParticlesBasedScalarData<Dim> & totalStiffnesses, const real scale) {
+        // Only a part of the last stiffnesses is reused, which would otherwise keep pushing particles that have parted.
+        _particles.parallelForEach(
+            [&](const int i) { totalStiffnesses[i] = _factors[i] ? totalStiffnesses[i] * _kWarmStartRatio : 0; });
+        applyStiffnesses(totalStiffnesses, scale);
+    }
+
+    template<int Dim>
+    void DivFreeSphLiquid<Dim>::updateStiffnesses(ParticlesBasedScalarData<Dim> & totalStiffnesses) {
+        // Damped projected Jacobi iterations. The factors ignore the coupling between neighbors, so the full update tends
+        // to overshoot. The total stiffness of a particle never gets negative, which leaves the free surface alone, but
+        // may decrease where the warm start overshoots. _stiffnesses turns from errors into increments.
+        _particles.parallelForEach([&](const int i) {
+            const real total = std::max(totalStiffnesses[i] + _kRelaxation * _stiffnesses[i] * _factors[i], real(0));
+            _stiffnesses[i]  = total - totalStiffnesses[i];
+            totalStiffnesses[i] = total;
+        });
+    }
+
+    template<int Dim> void DivFreeSphLiquid<Dim>::computeFactors() {
+        _particles.parallelForEach([&](const int i) {
+            const VectorDr pos_i      = _particles.positions[i];
+            VectorDr       gradSum    = VectorDr::Zero();
+            real           squaredSum = 0;
+            _particles.forEachNearby(pos_i, [&](const int, const VectorDr & pos_j) {
+                const VectorDr grad = _particles.mass() * _particles.gradientKernel(pos_j - pos_i);
+                gradSum += grad;
+                squaredSum += grad.squaredNorm();
+            });
+            const real denom = gradSum.squaredNorm() + squaredSum;
+            _factors[i]      = denom > std::numeric_limits<real>::epsilon() ? _particles.densities[i] / denom : 0;
+        });
+    }
+
+    template<int Dim> real DivFreeSphLiquid<Dim>::computeDensityChangeRate(const int i) const {
+        const VectorDr pos_i = _particles.positions[i];
+        real           rate  = 0;
+        _particles.forEachNearby(pos_i, [&](const int j, const VectorDr & pos_j) {
+            rate += (_velocities[i] - _velocities[j]).dot(_particles.gradientKernel(pos_j - pos_i));
+        });
+        return rate * _particles.mass();
+    }
+
+    template<int Dim>
+    void DivFreeSphLiquid<Dim>::applyStiffnesses(const ParticlesBasedScalarData<Dim> & stiffnesses, const real scale) {
+        _particles.parallelForEach([&](const int i) {
+            const VectorDr pos_i   = _particles.positions[i];
+            const real     ratio_i = stiffnesses[i] / _particles.densities[i];
+            VectorDr       delta   = VectorDr::Zero();
+            _particles.forEachNearby(pos_i, [&](const int j, const VectorDr & pos_j) {
+                delta += (ratio_i + stiffnesses[j] / _particles.densities[j]) * _particles.gradientKernel(pos_j - pos_i);
+            });
+            _velocities[i] -= delta * _particles.mass() * scale;
+        });
+    }
+
+    template class DivFreeSphLiquid<2>;
+    template class DivFreeSphLiquid<3>;
+
+} // namespace PhysX
@@ -4,6 +4,12 @@
 
 namespace PhysX {
 
+    // Divergence-free SPH [Bender and Koschier 2015].
+    //
+    // Pressure is solved in two passes sharing the per-particle factors alpha, which only depend on positions. Before
+    // moving particles, the constant density solver corrects predicted density errors; after moving them, the
+    // divergence solver removes the remaining compression rate. Both solvers are Jacobi iterations on velocities,
+    // warm-started from the stiffnesses accumulated in the previous step.
     template<int Dim> class DivFreeSphLiquid : public SmthParticleHydrodLiquid<Dim> {
         DECLARE_DIM_TYPES(Dim)
 
@@ -16,6 +22,19 @@ namespace PhysX {
         using SmthParticleHydrodLiquid<Dim>::_viscosityCoeff;
         using SmthParticleHydrodLiquid<Dim>::_targetDensity;
 
+        static constexpr int  _kMaxIters             = 100;
+        static constexpr int  _kMinDensityIters      = 2;
+        static constexpr real _kRelaxation           = real(.5);
+        static constexpr real _kWarmStartRatio       = real(.5);
+        static constexpr real _kDensityErrorRatio    = real(.001); // of the average density error to the target
+        static constexpr real _kDivergenceErrorRatio = real(.001); // of the average density change in a step to the target
+        static constexpr real _kMaxTimeStep          = real(5e-3);
+
+        ParticlesBasedScalarData<Dim> _factors;
+        ParticlesBasedScalarData<Dim> _densityStiffnesses;
+        ParticlesBasedScalarData<Dim> _divergenceStiffnesses;
+        ParticlesBasedScalarData<Dim> _stiffnesses;
+
     public:
         DivFreeSphLiquid(const real particleRadius): SmthParticleHydrodLiquid<Dim>(particleRadius) {}
 
@@ -23,21 +42,28 @@ namespace PhysX {
         DivFreeSphLiquid & operator=(const DivFreeSphLiquid & rhs) = delete;
         virtual ~DivFreeSphLiquid()                                = default;
 
-        virtual void initialize() override;
+        virtual real getTimeStep(const uint frameRate, const real stepRate) const override;
 
-    protected:
-        virtual void writeDescription(YAML::Node & root) const override;
-        virtual void writeFrame(const std::string & frameDir, const bool staticDraw) const override;
+        virtual void advance(const real dt) override;
 
-        void moveParticles(const real dt) override;
+    protected:
+        using SmthParticleHydrodLiquid<Dim>::applyExternalForces;
+        using SmthParticleHydrodLiquid<Dim>::applyViscosityForce;
 
-        void correctDensity();
-        void correctVelocity();
+        virtual void reinitializeParticlesBasedData() override;
+        virtual void moveParticles(const real dt) override;
 
         void updateVelocity(const real dt);
-        void applyExternalForces(const real dt) override;
-        void applyViscosityForce(const real dt) override;
-        void applySurfaceTension(const real dt);
+        void correctDensity(const real dt);
+        void correctVelocity(const real dt);
+
+        void computeFactors();
+        void resolveCollisions(const real dt);
+        real computeDensityChangeRate(const int i) const;
+        real sumOfCompression() const;
+        void warmStart(ParticlesBasedScalarData<Dim> & totalStiffnesses, const real scale);
+        void updateStiffnesses(ParticlesBasedScalarData<Dim> & totalStiffnesses);
+        void applyStiffnesses(const ParticlesBasedScalarData<Dim> & stiffnesses, const real scale);
     };
 
 } // namespace PhysX
@@ -3,6 +3,10 @@
 #include "Geometries/ImplicitSurface.h"
 #include "Utilities/Constants.h"
 
+#include <fmt/core.h>
+
+#include <iostream>
+
 namespace PhysX {
 
     template<int Dim> void DualParticleSphLiquid<Dim>::writeDescription(YAML::Node & root) const {
@@ -13,6 +17,7 @@ namespace PhysX {
             node["primitive_type"]             = "point_list";
             node["material"]["diffuse_albedo"] = (Vector4f(52, 108, 156, 255) / 255).eval(); // Haijun Blue
             node["indexed"]                    = false;
+            node["constant_normal"]            = Vector3f::Unit(2).eval();
             node["color_map"]["enabled"]       = true;
             root["objects"].push_back(node);
         }
@@ -23,6 +28,7 @@ namespace PhysX {
             node["primitive_type"]             = "point_list";
             node["material"]["diffuse_albedo"] = (Vector4f(52, 108, 156, 255) / 255).eval(); // Haijun Blue
             node["indexed"]                    = false;
+            node["constant_normal"]            = Vector3f::Unit(2).eval();
             node["color_map"]["enabled"]       = true;
             root["objects"].push_back(node);
         }
@@ -33,44 +39,31 @@ namespace PhysX {
             node["primitive_type"]             = "point_list";
             node["material"]["diffuse_albedo"] = (Vector4f(52, 108, 156, 255) / 255).eval(); // Haijun Blue
             node["indexed"]                    = false;
+            node["constant_normal"]            = Vector3f::Unit(2).eval();
             node["color_map"]["enabled"]       = false;
             root["objects"].push_back(node);
         }
     }
 
     template<int Dim>
-    void DualParticleSphLiquid<Dim>::writeFrame(const std::string & frameDir, const bool staticDraw) const {
+    void DualParticleSphLiquid<Dim>::writeFrame(FrameBuffer & frame, const bool staticDraw) const {
         { // Write particles.
-            std::ofstream fout(frameDir + "/particles.mesh", std::ios::binary);
+            auto & fout = frame.open("particles.mesh");
             IO::writeValue(fout, uint(_particles.size()));
-            _particles.forEach(
-                [&](const int i) { IO::writeValue(fout, _particles.positions[i].template cast<float>().eval()); });
-            if constexpr (Dim == 3) {
-                _particles.forEach([&](const int i) { IO::writeValue(fout, VectorDf::Unit(2).eval()); });
-            }
-            _particles.forEach([&](const int i) { IO::writeValue(fout, float(_velocities[i].norm())); });
+            IO::writeCast<float>(fout, _particles.positions);
+            frame.writeHeats(fout, _particles.size(), [&](const int i) { return float(_velocities[i].norm()); });
         }
         { // Write particles.
-            std::ofstream fout(frameDir + "/virtual_particles.mesh", std::ios::binary);
+            auto & fout = frame.open("virtual_particles.mesh");
             IO::writeValue(fout, uint(_virtual_particles.size()));
-            _virtual_particles.forEach([&](const int i) {
-                IO::writeValue(fout, _virtual_particles.positions[i].template cast<float>().eval());
-            });
-            if constexpr (Dim == 3) {
-                _virtual_particles.forEach([&](const int i) { IO::writeValue(fout, VectorDf::Unit(2).eval()); });
-            }
-            _virtual_particles.forEach(
-                [&](const int i) { IO::writeValue(fout, float(_virtual_particles.volumes[i])); });
+            IO::writeCast<float>(fout, _virtual_particles.positions);
+            frame.writeHeats(
+                fout, _virtual_particles.size(), [&](const int i) { return float(_virtual_particles.volumes[i]); });
         }
         { // Write particles.
-            std::ofstream fout(frameDir + "/boundary_particles.mesh", std::ios::binary);
+            auto & fout = frame.open("boundary_particles.mesh");
             IO::writeValue(fout, uint(_boundary_particles.size()));
-            _boundary_particles.forEach([&](const int i) {
-                IO::writeValue(fout, _boundary_particles.positions[i].template cast<float>().eval());
-            });
-            if constexpr (Dim == 3) {
-                _boundary_particles.forEach([&](const int i) { IO::writeValue(fout, VectorDf::Unit(2).eval()); });
-            }
+            IO::writeCast<float>(fout, _boundary_particles.positions);
             //_particles.forEach([&](const int i) { IO::writeValue(fout, float(_velocities[i].norm())); });
         }
     }
@@ -96,6 +89,7 @@ namespace PhysX {
         _virtual_particles.setAlpha(_particles, _targetDensity);
 
         _virtual_particles.setKappa(1. / _particles.getPackedKernelSum());
+        if (_printsProjectionStats) _virtual_particles.setStats(&_projectionStats);
 
         /*double omega = 2.;
 
@@ -118,6 +112,19 @@ namespace PhysX {
         _virtual_particles.generateParticles(_particles);
 
         applyPressureForce(dt);
+
+        if (_printsProjectionStats) {
+            std::cout << fmt::format(
+                "   Virtual particles: {:>7}, nonzeros: {:>8}, iterations: {:>4}, residual: {:.2e}, max divergence: {:.2e}, "
+                "min diagonal: {:.2e}",
+                _projectionStats.particleCount,
+                _projectionStats.nonZeros,
+                _projectionStats.iterations,
+                _projectionStats.residual,
+                _projectionStats.maxDivergence,
+                _projectionStats.minDiagonal)
+                      << std::endl;
+        }
     }
 
     template<int Dim> void DualParticleSphLiquid<Dim>::applyPressureForce(const real dt) {
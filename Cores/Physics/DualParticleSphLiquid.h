@@ -8,6 +8,9 @@ namespace PhysX {
     template<int Dim> class DualParticleSphLiquid : public SmthParticleHydrodLiquid<Dim> {
         DECLARE_DIM_TYPES(Dim)
 
+    public:
+        friend class SmthPartHydrodLiquidBuilder;
+
     protected:
         using SmthParticleHydrodLiquid<Dim>::_particles;
         using SmthParticleHydrodLiquid<Dim>::_velocities;
@@ -19,6 +22,9 @@ namespace PhysX {
 
         double _alpha_0;
 
+        bool                   _printsProjectionStats = false;
+        VirtualProjectionStats _projectionStats;
+
         using SmthParticleHydrodLiquid<Dim>::_enableGravity;
         using SmthParticleHydrodLiquid<Dim>::_viscosityCoeff;
         using SmthParticleHydrodLiquid<Dim>::_targetDensity;
@@ -36,7 +42,7 @@ namespace PhysX {
         using SmthParticleHydrodLiquid<Dim>::dimension;
 
         virtual void writeDescription(YAML::Node & root) const override;
-        virtual void writeFrame(const std::string & frameDir, const bool staticDraw) const override;
+        virtual void writeFrame(FrameBuffer & frame, const bool staticDraw) const override;
 
         using SmthParticleHydrodLiquid<Dim>::saveFrame;
         using SmthParticleHydrodLiquid<Dim>::loadFrame;
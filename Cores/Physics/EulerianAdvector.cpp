@@ -1,48 +1,71 @@
 #include "EulerianAdvector.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 namespace PhysX {
 
 template <int Dim, int RungeKuttaOrder>
 void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(GridBasedScalarField<Dim> &field, const VectorField<Dim> &flow, const real dt)
 {
-	GridBasedScalarField<Dim> newField(field.grid());
-	advect(field, newField, flow, dt);
-	field = newField;
+	const auto newField = _scalarFieldPool.acquire(field.grid());
+	advect(field, *newField, flow, dt);
+	field.swap(*newField);
+}
+
+template <int Dim, int RungeKuttaOrder>
+void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(NarrowBandLevelSet<Dim> &levelSet, const VectorField<Dim> &flow, const real dt)
+{
+	const NarrowBandLevelSet<Dim> oldLevelSet(levelSet);
+	advect(oldLevelSet, levelSet, flow, dt);
 }
 
 template <int Dim, int RungeKuttaOrder>
 void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(StaggeredGridBasedVectorField<Dim> &field, const VectorField<Dim> &flow, const real dt)
 {
-	StaggeredGridBasedVectorField<Dim> newField(field.staggeredGrid());
-	advect(field, newField, flow, dt);
-	field = newField;
+	const auto newField = _vectorFieldPool.acquire(field.staggeredGrid());
+	advect(field, *newField, flow, dt);
+	field.swap(*newField);
 }
 
 template <int Dim, int RungeKuttaOrder>
 void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(ParticlesVectorAttribute<Dim> &positions, const VectorField<Dim> &flow, const real dt)
 {
-	positions.parallelForEach([&](const int i) {
-		VectorDr &pos = positions[i];
-		pos = trace(pos, flow, dt);
-	});
+	const int cnt = int(positions.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int begin = 0; begin < cnt; begin += _kBatchSize)
+		trace(positions.data() + begin, positions.data() + begin, std::min(cnt - begin, _kBatchSize), flow, dt);
 }
 
 template <int Dim, int RungeKuttaOrder>
 void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(const GridBasedScalarField<Dim> &field, GridBasedScalarField<Dim> &newField, const VectorField<Dim> &flow, const real dt) const
 {
-	newField.parallelForEach([&](const VectorDi &coord) {
-		const VectorDr pos = newField.position(coord);
-		newField[coord] = field(trace(pos, flow, -dt));
+	traceDataPoints(newField.grid(), [&](const size_t begin, const int cnt, const VectorDr *departurePos) {
+		field.interpolate(departurePos, newField.data() + begin, cnt);
+	}, flow, -dt);
+}
+
+template <int Dim, int RungeKuttaOrder>
+void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(const NarrowBandLevelSet<Dim> &levelSet, NarrowBandLevelSet<Dim> &newLevelSet, const VectorField<Dim> &flow, const real dt) const
+{
+	// Data points out of the band are farther from the interface than a step may carry it, so only their signs matter.
+	newLevelSet.parallelForEach([&](const VectorDi &coord, real &val) {
+		const VectorDr pos = newLevelSet.grid()->dataPosition(coord);
+		val = levelSet.signedDistance(trace(pos, flow, -dt));
 	});
 }
 
 template <int Dim, int RungeKuttaOrder>
 void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(const StaggeredGridBasedVectorField<Dim> &field, StaggeredGridBasedVectorField<Dim> &newField, const VectorField<Dim> &flow, const real dt) const
 {
-	newField.parallelForEach([&](const int axis, const VectorDi &face) {
-		const VectorDr pos = newField[axis].position(face);
-		newField[axis][face] = field[axis](trace(pos, flow, -dt));
-	});
+	for (int axis = 0; axis < Dim; axis++) {
+		traceDataPoints(newField[axis].grid(), [&](const size_t begin, const int cnt, const VectorDr *departurePos) {
+			field[axis].interpolate(departurePos, newField[axis].data() + begin, cnt);
+		}, flow, -dt);
+	}
 }
 
 template <int Dim, int RungeKuttaOrder>
@@ -69,39 +92,134 @@ Vector<Dim, real> SemiLagrangianAdvector<Dim, RungeKuttaOrder>::trace(const Vect
 	}
 }
 
+template <int Dim, int RungeKuttaOrder>
+void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::trace(const VectorDr *startPos, VectorDr *endPos, const int cnt, const VectorField<Dim> &flow, const real dt) const
+{
+	std::array<VectorDr, _kBatchSize> pos;
+	std::array<std::array<VectorDr, _kBatchSize>, RungeKuttaOrder> vel;
+	flow.interpolate(startPos, vel[0].data(), cnt);
+	if constexpr (RungeKuttaOrder == 1) {
+		for (int i = 0; i < cnt; i++) endPos[i] = startPos[i] + vel[0][i] * dt;
+	}
+	else if constexpr (RungeKuttaOrder == 2) {
+		for (int i = 0; i < cnt; i++) pos[i] = startPos[i] + vel[0][i] * dt * 2 / 3;
+		flow.interpolate(pos.data(), vel[1].data(), cnt);
+		for (int i = 0; i < cnt; i++) endPos[i] = startPos[i] + (vel[0][i] + 3 * vel[1][i]) * dt / 4;
+	}
+	else if constexpr (RungeKuttaOrder == 3) {
+		for (int i = 0; i < cnt; i++) pos[i] = startPos[i] + vel[0][i] * dt / 2;
+		flow.interpolate(pos.data(), vel[1].data(), cnt);
+		for (int i = 0; i < cnt; i++) pos[i] = startPos[i] + vel[1][i] * dt * 3 / 4;
+		flow.interpolate(pos.data(), vel[2].data(), cnt);
+		for (int i = 0; i < cnt; i++) endPos[i] = startPos[i] + (vel[0][i] * 2 + vel[1][i] * 3 + vel[2][i] * 4) * dt / 9;
+	}
+	else {
+		for (int i = 0; i < cnt; i++) pos[i] = startPos[i] + vel[0][i] * dt * real(.4);
+		flow.interpolate(pos.data(), vel[1].data(), cnt);
+		for (int i = 0; i < cnt; i++) pos[i] = startPos[i] + (vel[0][i] * real(.29697761) + vel[1][i] * real(.15875964)) * dt;
+		flow.interpolate(pos.data(), vel[2].data(), cnt);
+		for (int i = 0; i < cnt; i++) pos[i] = startPos[i] + (vel[0][i] * real(.21810040) - vel[1][i] * real(3.05096516) + vel[2][i] * (3.83286476)) * dt;
+		flow.interpolate(pos.data(), vel[3].data(), cnt);
+		for (int i = 0; i < cnt; i++) endPos[i] = startPos[i] + (vel[0][i] * real(.17476028) - vel[1][i] * (.55148066) + vel[2][i] * real(1.20553560) + vel[3][i] * real(.17118478)) * dt;
+	}
+}
+
+template <int Dim, int RungeKuttaOrder>
+void SemiLagrangianAdvector<Dim, RungeKuttaOrder>::traceDataPoints(const Grid<Dim> *grid, const std::function<void(const size_t, const int, const VectorDr *)> &func, const VectorField<Dim> &flow, const real dt) const
+{
+	// Data points are traced in batches of consecutive indices, and func(begin, cnt, endPos) consumes each batch.
+	const int dataCnt = int(grid->dataCount());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int begin = 0; begin < dataCnt; begin += _kBatchSize) {
+		const int cnt = std::min(dataCnt - begin, _kBatchSize);
+		std::array<VectorDr, _kBatchSize> pos;
+		for (int i = 0; i < cnt; i++)
+			pos[i] = grid->dataPosition(grid->coordinate(begin + i));
+		trace(pos.data(), pos.data(), cnt, flow, dt);
+		func(begin, cnt, pos.data());
+	}
+}
+
 template <int Dim, int RungeKuttaOrder>
 void MacCormackAdvector<Dim, RungeKuttaOrder>::advect(GridBasedScalarField<Dim> &field, const VectorField<Dim> &flow, const real dt)
 {
-	GridBasedScalarField<Dim> forwardField(field.grid());
-	GridBasedScalarField<Dim> backwardField(field.grid());
-	SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(field, forwardField, flow, dt);
-	SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(forwardField, backwardField, flow, -dt);
-	field.parallelForEach([&](const VectorDi &coord) {
-		field[coord] = forwardField[coord] + (field[coord] - backwardField[coord]) * real(0.5);
+	const auto forwardField = _scalarFieldPool.acquire(field.grid());
+	const auto newField = _scalarFieldPool.acquire(field.grid());
+	SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(field, *forwardField, flow, dt);
+	newField->parallelForEach([&](const VectorDi &coord) {
+		(*newField)[coord] = correct(field, *forwardField, coord, flow, dt);
+	});
+	field.swap(*newField);
+}
+
+template <int Dim, int RungeKuttaOrder>
+void MacCormackAdvector<Dim, RungeKuttaOrder>::advect(NarrowBandLevelSet<Dim> &levelSet, const VectorField<Dim> &flow, const real dt)
+{
+	const NarrowBandLevelSet<Dim> oldLevelSet(levelSet);
+	NarrowBandLevelSet<Dim> forwardLevelSet(levelSet);
+	SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(oldLevelSet, forwardLevelSet, flow, dt);
+	levelSet.parallelForEach([&](const VectorDi &coord, real &val) {
+		const VectorDr pos = levelSet.grid()->dataPosition(coord);
+		const real forwardVal = forwardLevelSet.value(coord);
+		val = forwardVal + (val - forwardLevelSet.signedDistance(trace(pos, flow, dt))) * real(0.5);
+		real minVal = std::numeric_limits<real>::infinity();
+		real maxVal = -std::numeric_limits<real>::infinity();
+		for (const auto &nbCoord : levelSet.grid()->linearNearbyDataPoints(trace(pos, flow, -dt))) {
+			minVal = std::min(minVal, oldLevelSet.value(nbCoord));
+			maxVal = std::max(maxVal, oldLevelSet.value(nbCoord));
+		}
+		if (val < minVal || val > maxVal) val = forwardVal;
 	});
 }
 
 template <int Dim, int RungeKuttaOrder>
 void MacCormackAdvector<Dim, RungeKuttaOrder>::advect(StaggeredGridBasedVectorField<Dim> &field, const VectorField<Dim> &flow, const real dt)
 {
-	StaggeredGridBasedVectorField<Dim> forwardField(field.staggeredGrid());
-	StaggeredGridBasedVectorField<Dim> backwardField(field.staggeredGrid());
-	SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(field, forwardField, flow, dt);
-	SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(forwardField, backwardField, flow, -dt);
-	field.parallelForEach([&](const int axis, const VectorDi &coord) {
-		field[axis][coord] = forwardField[axis][coord] + (field[axis][coord] - backwardField[axis][coord]) * real(0.5);
+	const auto forwardField = _vectorFieldPool.acquire(field.staggeredGrid());
+	const auto newField = _vectorFieldPool.acquire(field.staggeredGrid());
+	SemiLagrangianAdvector<Dim, RungeKuttaOrder>::advect(field, *forwardField, flow, dt);
+	newField->parallelForEach([&](const int axis, const VectorDi &face) {
+		(*newField)[axis][face] = correct(field[axis], (*forwardField)[axis], face, flow, dt);
 	});
+	field.swap(*newField);
 }
 
 template <int Dim, int RungeKuttaOrder>
 void MacCormackAdvector<Dim, RungeKuttaOrder>::advect(ParticlesVectorAttribute<Dim> &positions, const VectorField<Dim> &flow, const real dt)
 {
-	positions.parallelForEach([&](const int i) {
-		VectorDr &pos = positions[i];
-		const VectorDr forwardPos = trace(pos, flow, dt);
-		const VectorDr backwardPos = trace(forwardPos, flow, -dt);
-		pos = forwardPos + (pos - backwardPos) * real(0.5);
-	});
+	const int cnt = int(positions.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int begin = 0; begin < cnt; begin += _kBatchSize) {
+		const int batchCnt = std::min(cnt - begin, _kBatchSize);
+		VectorDr *const pos = positions.data() + begin;
+		std::array<VectorDr, _kBatchSize> forwardPos, backwardPos;
+		trace(pos, forwardPos.data(), batchCnt, flow, dt);
+		trace(forwardPos.data(), backwardPos.data(), batchCnt, flow, -dt);
+		for (int i = 0; i < batchCnt; i++)
+			pos[i] = forwardPos[i] + (pos[i] - backwardPos[i]) * real(0.5);
+	}
+}
+
+template <int Dim, int RungeKuttaOrder>
+real MacCormackAdvector<Dim, RungeKuttaOrder>::correct(const GridBasedScalarField<Dim> &field, const GridBasedScalarField<Dim> &forwardField, const VectorDi &coord, const VectorField<Dim> &flow, const real dt) const
+{
+	// The backward step, the error compensation and the limiter of [Selle et al. 2008] are fused into one pass.
+	// Wherever the corrected value leaves the range of the stencil around the departure point, it reverts to the
+	// semi-Lagrangian one.
+	const VectorDr pos = field.position(coord);
+	const real forwardVal = forwardField[coord];
+	const real val = forwardVal + (field[coord] - forwardField(trace(pos, flow, dt))) * real(0.5);
+	real minVal = std::numeric_limits<real>::infinity();
+	real maxVal = -std::numeric_limits<real>::infinity();
+	for (const auto &nbCoord : field.grid()->linearNearbyDataPoints(trace(pos, flow, -dt))) {
+		minVal = std::min(minVal, field.at(nbCoord));
+		maxVal = std::max(maxVal, field.at(nbCoord));
+	}
+	return val < minVal || val > maxVal ? forwardVal : val;
 }
 
 template class EulerianAdvector<2>;
@@ -1,8 +1,10 @@
 #pragma once
 
+#include "Geometries/NarrowBandLevelSet.h"
 #include "Structures/GridBasedScalarField.h"
 #include "Structures/GridBasedVectorField.h"
 #include "Structures/ParticlesAttribute.h"
+#include "Structures/ScratchPool.h"
 #include "Structures/StaggeredGridBasedVectorField.h"
 
 namespace PhysX {
@@ -20,6 +22,7 @@ public:
 	virtual ~EulerianAdvector() = default;
 
 	virtual void advect(GridBasedScalarField<Dim> &field, const VectorField<Dim> &flow, const real dt) = 0;
+	virtual void advect(NarrowBandLevelSet<Dim> &levelSet, const VectorField<Dim> &flow, const real dt) = 0;
 	virtual void advect(StaggeredGridBasedVectorField<Dim> &field, const VectorField<Dim> &flow, const real dt) = 0;
 	virtual void advect(ParticlesVectorAttribute<Dim> &positions, const VectorField<Dim> &flow, const real dt) = 0;
 };
@@ -31,6 +34,13 @@ class SemiLagrangianAdvector : public EulerianAdvector<Dim>
 
 	static_assert(1 <= RungeKuttaOrder && RungeKuttaOrder <= 4, "Runge-Kutta order must be 1, 2, 3 or 4.");
 
+protected:
+
+	static constexpr int _kBatchSize = 64;
+
+	ScratchPool<GridBasedScalarField<Dim>> _scalarFieldPool;
+	ScratchPool<StaggeredGridBasedVectorField<Dim>> _vectorFieldPool;
+
 public:
 
 	SemiLagrangianAdvector() = default;
@@ -39,15 +49,20 @@ public:
 	virtual ~SemiLagrangianAdvector() = default;
 
 	virtual void advect(GridBasedScalarField<Dim> &field, const VectorField<Dim> &flow, const real dt) override;
+	virtual void advect(NarrowBandLevelSet<Dim> &levelSet, const VectorField<Dim> &flow, const real dt) override;
 	virtual void advect(StaggeredGridBasedVectorField<Dim> &field, const VectorField<Dim> &flow, const real dt) override;
 	virtual void advect(ParticlesVectorAttribute<Dim> &positions, const VectorField<Dim> &flow, const real dt) override;
 
 protected:
 
 	void advect(const GridBasedScalarField<Dim> &field, GridBasedScalarField<Dim> &newField, const VectorField<Dim> &flow, const real dt) const;
+	void advect(const NarrowBandLevelSet<Dim> &levelSet, NarrowBandLevelSet<Dim> &newLevelSet, const VectorField<Dim> &flow, const real dt) const;
 	void advect(const StaggeredGridBasedVectorField<Dim> &field, StaggeredGridBasedVectorField<Dim> &newField, const VectorField<Dim> &flow, const real dt) const;
 
 	VectorDr trace(const VectorDr &startPos, const VectorField<Dim> &flow, const real dt) const;
+	// Traces up to _kBatchSize positions at once; endPos may alias startPos.
+	void trace(const VectorDr *startPos, VectorDr *endPos, const int cnt, const VectorField<Dim> &flow, const real dt) const;
+	void traceDataPoints(const Grid<Dim> *grid, const std::function<void(const size_t, const int, const VectorDr *)> &func, const VectorField<Dim> &flow, const real dt) const;
 };
 
 template <int Dim, int RungeKuttaOrder = 2>
@@ -65,12 +80,19 @@ public:
 	virtual ~MacCormackAdvector() = default;
 
 	virtual void advect(GridBasedScalarField<Dim> &field, const VectorField<Dim> &flow, const real dt) override;
+	virtual void advect(NarrowBandLevelSet<Dim> &levelSet, const VectorField<Dim> &flow, const real dt) override;
 	virtual void advect(StaggeredGridBasedVectorField<Dim> &field, const VectorField<Dim> &flow, const real dt) override;
 	virtual void advect(ParticlesVectorAttribute<Dim> &positions, const VectorField<Dim> &flow, const real dt) override;
 
 protected:
 
+	using SemiLagrangianAdvector<Dim, RungeKuttaOrder>::_kBatchSize;
+	using SemiLagrangianAdvector<Dim, RungeKuttaOrder>::_scalarFieldPool;
+	using SemiLagrangianAdvector<Dim, RungeKuttaOrder>::_vectorFieldPool;
+
 	using SemiLagrangianAdvector<Dim, RungeKuttaOrder>::trace;
+
+	real correct(const GridBasedScalarField<Dim> &field, const GridBasedScalarField<Dim> &forwardField, const VectorDi &coord, const VectorField<Dim> &flow, const real dt) const;
 };
 
 }
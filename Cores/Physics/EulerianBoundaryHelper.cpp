@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 
 namespace PhysX {
 
@@ -19,45 +20,59 @@ void EulerianBoundaryHelper<Dim>::reset(
 	const std::vector<std::unique_ptr<Collider<Dim>>> &colliders,
 	const std::function<real(const int axis, const VectorDi &face)> &domainBoundaryVelocity)
 {
+	_surface.clear();
 	for (const auto &collider : colliders)
 		_surface.unionSurface(*collider->surface());
-	// Colliders must not intersect each other, or we should reinitialize _surface here.
+	// The minimum of signed distances is exact outside the colliders but only a bound inside where they overlap, e.g.,
+	// when dynamic colliders pass through each other. Only its signs and its closest positions from inside are used, so
+	// it is not reinitialized, neither here nor in update().
 
 	_fraction.parallelForEach([&](const int axis, const VectorDi &face) {
-		const VectorDr pos = _fraction[axis].position(face);
-		if (_fraction.isBoundary(axis, face)) {
-			_fraction[axis][face] = 1;
-			_velocity[axis][face] = domainBoundaryVelocity ? domainBoundaryVelocity(axis, face) : real(0);
-			_normal[axis][face] = -_domainBox.closestNormal(pos)[axis];
-		}
-		else {
-			_fraction[axis][face] = getFaceFraction(axis, face);
-			for (const auto &collider : colliders) {
-				if (collider->surface()->isInside(pos)) {
-					_velocity[axis][face] = collider->velocityAt(pos)[axis];
-					_normal[axis][face] = collider->surface()->closestNormal(pos)[axis];
-					break;
-				}
-			}
-		}
+		updateFace(colliders, domainBoundaryVelocity, axis, face);
+	});
+}
+
+template <int Dim>
+void EulerianBoundaryHelper<Dim>::update(
+	const std::vector<std::unique_ptr<Collider<Dim>>> &colliders,
+	const std::function<real(const int axis, const VectorDi &face)> &domainBoundaryVelocity,
+	const VectorDr &minCorner,
+	const VectorDr &maxCorner)
+{
+	// Only signs of distances away from the colliders matter to fractions, and they do not change out of the box. The
+	// box is padded so that every edge crossing a moved surface and every face touching such an edge are covered.
+	const VectorDr padding = VectorDr::Ones() * _fraction.spacing() * 2;
+	auto &sdf = _surface.signedDistanceField();
+	forEachInBox(sdf.grid(), minCorner - padding, maxCorner + padding, [&](const VectorDi &node) {
+		const VectorDr pos = sdf.position(node);
+		real phi = std::numeric_limits<real>::infinity();
+		for (const auto &collider : colliders)
+			phi = std::min(phi, collider->surface()->signedDistance(pos));
+		sdf[node] = phi;
 	});
+	for (int axis = 0; axis < Dim; axis++) {
+		forEachInBox(_fraction[axis].grid(), minCorner - padding, maxCorner + padding, [&](const VectorDi &face) {
+			updateFace(colliders, domainBoundaryVelocity, axis, face);
+		});
+	}
 }
 
 template <int Dim>
 void EulerianBoundaryHelper<Dim>::enforce(StaggeredGridBasedVectorField<Dim> &fluidVelocity) const
 {
-	auto newFluidVelocity = fluidVelocity;
-	newFluidVelocity.parallelForEach([&](const int axis, const VectorDi &face) {
+	const auto newFluidVelocity = _vectorFieldPool.acquire(fluidVelocity.staggeredGrid());
+	newFluidVelocity->parallelForEach([&](const int axis, const VectorDi &face) {
 		if (_fraction[axis][face] == 1) {
-			const VectorDr pos = newFluidVelocity[axis].position(face);
+			const VectorDr pos = (*newFluidVelocity)[axis].position(face);
 			const VectorDr n = _normal(pos).normalized();
 			if (n.any())
-				newFluidVelocity[axis][face] -= (fluidVelocity(pos) - _velocity(pos)).dot(n) * _normal[axis][face];
+				(*newFluidVelocity)[axis][face] = fluidVelocity[axis][face] - (fluidVelocity(pos) - _velocity(pos)).dot(n) * _normal[axis][face];
 			else
-				newFluidVelocity[axis][face] = _velocity[axis][face];
+				(*newFluidVelocity)[axis][face] = _velocity[axis][face];
 		}
+		else (*newFluidVelocity)[axis][face] = fluidVelocity[axis][face];
 	});
-	fluidVelocity = newFluidVelocity;
+	fluidVelocity.swap(*newFluidVelocity);
 }
 
 template <int Dim>
@@ -76,100 +91,171 @@ void EulerianBoundaryHelper<Dim>::enforce(ParticlesVectorAttribute<Dim> &particl
 template <int Dim>
 void EulerianBoundaryHelper<Dim>::extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const int maxSteps) const
 {
-	auto newFluidVelocty = fluidVelocity;
-	auto visited = std::make_unique<StaggeredGridBasedData<Dim, uchar>>(fluidVelocity.staggeredGrid());
-	auto newVisited = std::make_unique<StaggeredGridBasedData<Dim, uchar>>(fluidVelocity.staggeredGrid());
+	extrapolateInLayers(fluidVelocity, [&](const int axis, const VectorDi &face) {
+		return _fraction[axis][face] < 1;
+	}, [](const int, const VectorDi &) { return false; }, maxSteps);
+}
 
-	visited->parallelForEach([&](const int axis, const VectorDi &face) {
-		if (!((*visited)[axis][face] = _fraction[axis][face] < 1))
-			newFluidVelocty[axis][face] = 0;
-	});
+template <int Dim>
+void EulerianBoundaryHelper<Dim>::extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const LevelSet<Dim> &liquidLevelSet, const int maxSteps) const
+{
+	extrapolate<LevelSet<Dim>>(fluidVelocity, liquidLevelSet, maxSteps, std::numeric_limits<real>::infinity());
+}
 
-	for (int iter = 0; iter < maxSteps || (maxSteps < 0 && visited->template sum<size_t>() < visited->count()); iter++) {
-		newFluidVelocty.parallelForEach([&](const int axis, const VectorDi &face) {
-			if (!(*visited)[axis][face]) {
-				int cnt = 0;
-				real sum = 0;
-				for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
-					const VectorDi &nbFace = Grid<Dim>::neighbor(face, i);
-					if (newFluidVelocty[axis].isValid(nbFace) && (*visited)[axis][nbFace])
-						sum += newFluidVelocty[axis][nbFace], cnt++;
-				}
-				if (cnt > 0) {
-					newFluidVelocty[axis][face] = sum / cnt;
-					(*newVisited)[axis][face] = true;
-				}
-			}
-			else (*newVisited)[axis][face] = true;
-		});
-		visited.swap(newVisited);
-	}
-	fluidVelocity = newFluidVelocty;
+template <int Dim>
+void EulerianBoundaryHelper<Dim>::extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const NarrowBandLevelSet<Dim> &liquidLevelSet, const int maxSteps) const
+{
+	// Faces of a layer are at most one cell farther from the liquid than faces of the previous one. Thus faces both of
+	// whose cells are at least maxSteps + 1 cells away are never reached, and the band tells so for every face outside it.
+	const real reach = (maxSteps + 1) * fluidVelocity.spacing();
+	extrapolate<NarrowBandLevelSet<Dim>>(fluidVelocity, liquidLevelSet, maxSteps, maxSteps >= 0 && reach <= liquidLevelSet.bandWidth() ? reach : std::numeric_limits<real>::infinity());
 }
 
+template <int Dim>
+void EulerianBoundaryHelper<Dim>::extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const StaggeredGridBasedScalarData<Dim> &weightSum, const int maxSteps) const
+{
+	extrapolateInLayers(fluidVelocity, [&](const int axis, const VectorDi &face) {
+		return _fraction[axis][face] < 1 && weightSum[axis][face] > 0;
+	}, [](const int, const VectorDi &) { return false; }, maxSteps);
+}
 
 template <int Dim>
-void EulerianBoundaryHelper<Dim>::extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const LevelSet<Dim> &liquidLevelSet, const int maxSteps) const
+template <typename LevelSetType>
+void EulerianBoundaryHelper<Dim>::extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const LevelSetType &liquidLevelSet, const int maxSteps, const real farDistance) const
 {
-	const auto &liquidSdf = liquidLevelSet.signedDistanceField();
-	const auto isLiquidFace = [&](const int axis, const VectorDi &face)->bool {
+	extrapolateInLayers(fluidVelocity, [&](const int axis, const VectorDi &face) {
+		const VectorDi cell0 = StaggeredGrid<Dim>::faceAdjacentCell(axis, face, 0);
+		const VectorDi cell1 = StaggeredGrid<Dim>::faceAdjacentCell(axis, face, 1);
+		return _fraction[axis][face] < 1 && (Surface<Dim>::isInside(liquidLevelSet.value(cell0)) || Surface<Dim>::isInside(liquidLevelSet.value(cell1)));
+	}, [&](const int axis, const VectorDi &face) {
 		const VectorDi cell0 = StaggeredGrid<Dim>::faceAdjacentCell(axis, face, 0);
 		const VectorDi cell1 = StaggeredGrid<Dim>::faceAdjacentCell(axis, face, 1);
-		return _fraction[axis][face] < 1 && (Surface<Dim>::isInside(liquidSdf[cell0]) || Surface<Dim>::isInside(liquidSdf[cell1]));
-	};
-
-	auto newFluidVelocity = fluidVelocity;
-	newFluidVelocity.parallelForEach([&](const int axis, const VectorDi &face) {
-		if (isLiquidFace(axis, face)) return;
-		int cnt = 0;
-		real sum = 0;
-		for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
-			const VectorDi &nbFace = Grid<Dim>::neighbor(face, i);
-			if (newFluidVelocity[axis].isValid(nbFace) && isLiquidFace(axis, nbFace))
-				sum += newFluidVelocity[axis][nbFace], cnt++;
+		return liquidLevelSet.value(cell0) >= farDistance && liquidLevelSet.value(cell1) >= farDistance;
+	}, maxSteps);
+}
+
+template <int Dim>
+template <typename IsKnown, typename IsFar>
+void EulerianBoundaryHelper<Dim>::extrapolateInLayers(StaggeredGridBasedVectorField<Dim> &fluidVelocity, IsKnown &&isKnown, IsFar &&isFar, const int maxSteps) const
+{
+	// Velocities are extrapolated layer by layer. Faces of a layer are unknown faces next to known ones; they are updated
+	// in parallel from their known neighbors and then become known. The first layer is gathered by the pass that marks
+	// known faces and clears unknown ones, and each next layer from the neighbors of the current one, so the whole grid
+	// is visited only once. Far faces are cleared right away, so only faces near the liquid are classified and tested for
+	// known neighbors. Faces not reached within maxSteps layers are left zero.
+	const auto flagsHandle = _flagsPool.acquire(fluidVelocity.staggeredGrid());
+	auto &flags = *flagsHandle;
+	std::array<std::vector<int>, Dim> layer, nextLayer;
+
+	for (int axis = 0; axis < Dim; axis++) {
+		const int cnt = int(flags[axis].count());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		{
+			std::vector<int> seeds;
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+			for (int idx = 0; idx < cnt; idx++) {
+				const VectorDi face = flags[axis].coordinate(idx);
+				flags[axis][idx] = 0;
+				if (isFar(axis, face)) {
+					fluidVelocity[axis][idx] = 0;
+					continue;
+				}
+				if (isKnown(axis, face)) {
+					flags[axis][idx] = _kKnown;
+					continue;
+				}
+				fluidVelocity[axis][idx] = 0;
+				for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+					const VectorDi &nbFace = Grid<Dim>::neighbor(face, i);
+					if (flags[axis].isValid(nbFace) && isKnown(axis, nbFace)) {
+						flags[axis][idx] = _kQueued;
+						seeds.push_back(idx);
+						break;
+					}
+				}
+			}
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+			layer[axis].insert(layer[axis].end(), seeds.begin(), seeds.end());
 		}
-		if (cnt > 0) newFluidVelocity[axis][face] = sum / cnt;
-	});
+	}
 
-	const real bandWidth = maxSteps * fluidVelocity.spacing();
-	fluidVelocity.parallelForEach([&](const int axis, const VectorDi &face) {
-		const VectorDr pos = fluidVelocity[axis].position(face);
-		if (!isLiquidFace(axis, face)) {
-			fluidVelocity[axis][face] =
-				bandWidth < 0 || liquidLevelSet.signedDistance(pos) < bandWidth ? newFluidVelocity[axis](liquidLevelSet.closestPosition(pos)) : real(0);
+	// Values of a layer depend only on the faces known before it, so the order of faces within layers does not matter.
+	std::vector<real> values;
+	for (int iter = 0; iter < maxSteps || maxSteps < 0; iter++) {
+		if (std::all_of(layer.begin(), layer.end(), [](const auto &faces) { return faces.empty(); })) break;
+		for (int axis = 0; axis < Dim; axis++) {
+			const auto &faces = layer[axis];
+			values.resize(faces.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+			for (int j = 0; j < int(faces.size()); j++) {
+				const VectorDi face = flags[axis].coordinate(faces[j]);
+				int cnt = 0;
+				real sum = 0;
+				for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+					const VectorDi &nbFace = Grid<Dim>::neighbor(face, i);
+					if (flags[axis].isValid(nbFace) && flags[axis][nbFace] & _kKnown)
+						sum += fluidVelocity[axis][nbFace], cnt++;
+				}
+				values[j] = sum / cnt;
+			}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+			for (int j = 0; j < int(faces.size()); j++) {
+				fluidVelocity[axis][faces[j]] = values[j];
+				flags[axis][faces[j]] |= _kKnown;
+			}
 		}
-	});
+		for (int axis = 0; axis < Dim; axis++) {
+			nextLayer[axis].clear();
+			for (const int idx : layer[axis]) {
+				const VectorDi face = flags[axis].coordinate(idx);
+				for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
+					const VectorDi &nbFace = Grid<Dim>::neighbor(face, i);
+					if (flags[axis].isValid(nbFace) && !flags[axis][nbFace]) {
+						flags[axis][nbFace] = _kQueued;
+						nextLayer[axis].push_back(int(flags[axis].index(nbFace)));
+					}
+				}
+			}
+			layer[axis].swap(nextLayer[axis]);
+		}
+	}
 }
 
 template <int Dim>
-void EulerianBoundaryHelper<Dim>::extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const LevelSet<Dim> &liquidLevelSet, const StaggeredGridBasedScalarData<Dim> &weightSum, const int maxSteps) const
+void EulerianBoundaryHelper<Dim>::updateFace(
+	const std::vector<std::unique_ptr<Collider<Dim>>> &colliders,
+	const std::function<real(const int axis, const VectorDi &face)> &domainBoundaryVelocity,
+	const int axis,
+	const VectorDi &face)
 {
-	const auto &liquidSdf = liquidLevelSet.signedDistanceField();
-	const auto isLiquidFace = [&](const int axis, const VectorDi &face)->bool {
-		return _fraction[axis][face] < 1 && weightSum[axis][face];
-	};
-
-	auto newFluidVelocity = fluidVelocity;
-	newFluidVelocity.parallelForEach([&](const int axis, const VectorDi &face) {
-		if (isLiquidFace(axis, face)) return;
-		int cnt = 0;
-		real sum = 0;
-		for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
-			const VectorDi &nbFace = Grid<Dim>::neighbor(face, i);
-			if (newFluidVelocity[axis].isValid(nbFace) && isLiquidFace(axis, nbFace))
-				sum += newFluidVelocity[axis][nbFace], cnt++;
-		}
-		if (cnt > 0) newFluidVelocity[axis][face] = sum / cnt;
-	});
-
-	const real bandWidth = maxSteps * fluidVelocity.spacing();
-	fluidVelocity.parallelForEach([&](const int axis, const VectorDi &face) {
-		const VectorDr pos = fluidVelocity[axis].position(face);
-		if (!isLiquidFace(axis, face)) {
-			fluidVelocity[axis][face] =
-				bandWidth < 0 || liquidLevelSet.signedDistance(pos) < bandWidth ? newFluidVelocity[axis](liquidLevelSet.closestPosition(pos)) : real(0);
+	const VectorDr pos = _fraction[axis].position(face);
+	if (_fraction.isBoundary(axis, face)) {
+		_fraction[axis][face] = 1;
+		_velocity[axis][face] = domainBoundaryVelocity ? domainBoundaryVelocity(axis, face) : real(0);
+		_normal[axis][face] = -_domainBox.closestNormal(pos)[axis];
+	}
+	else {
+		_fraction[axis][face] = getFaceFraction(axis, face);
+		_velocity[axis][face] = 0;
+		_normal[axis][face] = 0;
+		for (const auto &collider : colliders) {
+			if (collider->surface()->isInside(pos)) {
+				_velocity[axis][face] = collider->velocityAt(pos)[axis];
+				_normal[axis][face] = collider->surface()->closestNormal(pos)[axis];
+				break;
+			}
 		}
-	});
+	}
 }
 
 template <int Dim>
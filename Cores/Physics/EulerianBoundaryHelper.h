@@ -2,12 +2,16 @@
 
 #include "Geometries/Collider.h"
 #include "Geometries/LevelSet.h"
+#include "Geometries/NarrowBandLevelSet.h"
+#include "Structures/ScratchPool.h"
 #include "Structures/StaggeredGridBasedData.h"
 #include "Structures/StaggeredGridBasedVectorField.h"
 #include "Structures/ParticlesAttribute.h"
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace PhysX {
 
@@ -24,6 +28,12 @@ protected:
 	StaggeredGridBasedVectorField<Dim> _velocity;
 	StaggeredGridBasedVectorField<Dim> _normal;
 
+	mutable ScratchPool<StaggeredGridBasedVectorField<Dim>> _vectorFieldPool;
+	mutable ScratchPool<StaggeredGridBasedData<Dim, uchar>> _flagsPool;
+
+	static constexpr uchar _kKnown = 1;
+	static constexpr uchar _kQueued = 2;
+
 public:
 
 	EulerianBoundaryHelper(const StaggeredGrid<Dim> *const grid);
@@ -39,16 +49,56 @@ public:
 		const std::vector<std::unique_ptr<Collider<Dim>>> &colliders,
 		const std::function<real(const int axis, const VectorDi &face)> &domainBoundaryVelocity);
 
+	// Recomputes the boundary only within the box, e.g., the region swept by moving colliders in a step.
+	void update(
+		const std::vector<std::unique_ptr<Collider<Dim>>> &colliders,
+		const std::function<real(const int axis, const VectorDi &face)> &domainBoundaryVelocity,
+		const VectorDr &minCorner,
+		const VectorDr &maxCorner);
+
 	void enforce(StaggeredGridBasedVectorField<Dim> &fluidVelocity) const;
 	void enforce(ParticlesVectorAttribute<Dim> &particlePositions) const;
 
 	void extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const int maxSteps = -1) const;
 	void extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const LevelSet<Dim> &liquidLevelSet, const int maxSteps = -1) const;
-	void extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const LevelSet<Dim> &liquidLevelSet, const StaggeredGridBasedScalarData<Dim> &weightSum, const int maxSteps = -1) const;
+	void extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const NarrowBandLevelSet<Dim> &liquidLevelSet, const int maxSteps = -1) const;
+	// Faces with positive particle weights are known.
+	void extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const StaggeredGridBasedScalarData<Dim> &weightSum, const int maxSteps = -1) const;
 
 protected:
 
+	// The liquid is given by a dense or a narrow-band level set, whose values are sampled at cells. Faces both of whose
+	// cells are at least farDistance outside the liquid must be out of reach of the extrapolation.
+	template <typename LevelSetType>
+	void extrapolate(StaggeredGridBasedVectorField<Dim> &fluidVelocity, const LevelSetType &liquidLevelSet, const int maxSteps, const real farDistance) const;
+	// Extrapolates velocities from the faces for which isKnown(axis, face) holds to at most maxSteps layers of the others.
+	// Faces for which isFar(axis, face) holds are neither known nor reached and are only cleared.
+	template <typename IsKnown, typename IsFar>
+	void extrapolateInLayers(StaggeredGridBasedVectorField<Dim> &fluidVelocity, IsKnown &&isKnown, IsFar &&isFar, const int maxSteps) const;
+
+	void updateFace(
+		const std::vector<std::unique_ptr<Collider<Dim>>> &colliders,
+		const std::function<real(const int axis, const VectorDi &face)> &domainBoundaryVelocity,
+		const int axis,
+		const VectorDi &face);
 	real getFaceFraction(const int axis, const VectorDi &face) const;
+
+	template <typename Func>
+	static void forEachInBox(const Grid<Dim> *const grid, const VectorDr &minCorner, const VectorDr &maxCorner, Func &&func)
+	{
+		const VectorDi lower = grid->getLinearLower(minCorner).cwiseMax(0);
+		const VectorDi upper = (grid->getLinearLower(maxCorner) + VectorDi::Ones()).cwiseMin(grid->dataSize() - VectorDi::Ones());
+		if ((upper.array() < lower.array()).any()) return;
+		const VectorDi size = upper - lower + VectorDi::Ones();
+		const int cnt = size.prod();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < cnt; i++) {
+			if constexpr (Dim == 2) func(lower + VectorDi(i % size.x(), i / size.x()));
+			else func(lower + VectorDi(i % size.x(), i / size.x() % size.y(), i / size.x() / size.y()));
+		}
+	}
 };
 
 }
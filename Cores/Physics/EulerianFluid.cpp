@@ -24,6 +24,7 @@ void EulerianFluid<Dim>::writeDescription(YAML::Node &root) const
 		node["data_mode"] = "dynamic";
 		node["primitive_type"] = "point_list";
 		node["indexed"] = false;
+		node["constant_normal"] = Vector3f::Unit(2).eval();
 		node["material"]["diffuse_albedo"] = Vector4f(0.5f, 0.5f, 0.5, 1.0f);
 		root["objects"].push_back(node);
 	}
@@ -39,58 +40,52 @@ void EulerianFluid<Dim>::writeDescription(YAML::Node &root) const
 }
 
 template <int Dim>
-void EulerianFluid<Dim>::writeFrame(const std::string &frameDir, const bool staticDraw) const
+void EulerianFluid<Dim>::writeFrame(FrameBuffer &frame, const bool staticDraw) const
 {
 	{ // Write neumann.
-		std::ofstream fout(frameDir + "/neumann.mesh", std::ios::binary);
-		uint cnt = 0;
+		auto &fout = frame.open("neumann.mesh");
+		std::vector<VectorDr> positions;
 		const auto &boundaryFraction = _boundaryHelper->fraction();
 		boundaryFraction.forEach([&](const int axis, const VectorDi &face) {
 			if (!boundaryFraction.isBoundary(axis, face) && boundaryFraction[axis][face] == 1)
-				cnt++;
+				positions.push_back(_grid.faceCenter(axis, face));
 		});
-		IO::writeValue(fout, cnt);
-		boundaryFraction.forEach([&](const int axis, const VectorDi &face) {
-			if (!boundaryFraction.isBoundary(axis, face) && boundaryFraction[axis][face] == 1)
-				IO::writeValue(fout, _grid.faceCenter(axis, face).template cast<float>().eval());
-		});
-		if constexpr (Dim == 3) {
-			boundaryFraction.forEach([&](const int axis, const VectorDi &face) {
-				if (!boundaryFraction.isBoundary(axis, face) && boundaryFraction[axis][face] == 1)
-					IO::writeValue(fout, VectorDf::Unit(2).eval());
-			});
-		}
+		IO::writeValue(fout, uint(positions.size()));
+		IO::writeCast<float>(fout, positions);
 	}
 	if constexpr (Dim == 2) { // Write velocity.
-		std::ofstream fout(frameDir + "/velocity.mesh", std::ios::binary);
+		auto &fout = frame.open("velocity.mesh");
 		IO::writeValue(fout, uint(2 * _grid.cellCount()));
-		_grid.forEachCell([&](const VectorDi &cell) {
-			const VectorDr pos = _grid.cellCenter(cell);
+		// Each cell gives a line of two vertices.
+		IO::writeMapped<VectorDf>(fout, 2 * _grid.cellCount(), [&](const int i) {
+			const VectorDr pos = _grid.cellCenter(_grid.cellGrid()->coordinate(i >> 1));
+			if (!(i & 1)) return pos.template cast<float>().eval();
 			const VectorDr dir = _velocity(pos).normalized() * _grid.spacing() * std::sqrt(real(Dim)) / 2;
-			IO::writeValue(fout, pos.template cast<float>().eval());
-			IO::writeValue(fout, (pos + dir).template cast<float>().eval());
+			return (pos + dir).template cast<float>().eval();
 		});
-		_grid.forEachCell([&](const VectorDi &cell) {
-			const VectorDr pos = _grid.cellCenter(cell);
-			const float vel = float(_velocity(pos).norm());
-			IO::writeValue(fout, vel);
-			IO::writeValue(fout, vel);
+		frame.writeHeats(fout, 2 * _grid.cellCount(), [&](const int i) {
+			return float(_velocity(_grid.cellCenter(_grid.cellGrid()->coordinate(i >> 1))).norm());
 		});
 	}
 }
 
 template <int Dim>
-void EulerianFluid<Dim>::saveFrame(const std::string &frameDir) const
+void EulerianFluid<Dim>::saveFrame(FrameBuffer &frame) const
 {
-	std::ofstream fout(frameDir + "/velocity.sav", std::ios::binary);
+	auto &fout = frame.open("velocity.sav");
 	_velocity.save(fout);
 }
 
 template <int Dim>
-void EulerianFluid<Dim>::loadFrame(const std::string &frameDir)
+void EulerianFluid<Dim>::loadFrame(const ArchivedFrame &frame)
 {
-	std::ifstream fin(frameDir + "/velocity.sav", std::ios::binary);
+	auto fin = frame.open("velocity.sav");
 	_velocity.load(fin);
+	// Dynamic colliders are moved to where they were when the frame was saved.
+	for (const auto &collider : _colliders) {
+		auto dynamicCollider = dynamic_cast<DynamicCollider<Dim> *>(collider.get());
+		if (dynamicCollider) dynamicCollider->setTime(_time);
+	}
 	updateBoundary();
 }
 
@@ -120,14 +115,14 @@ void EulerianFluid<Dim>::advectFields(const real dt)
 template <int Dim>
 void EulerianFluid<Dim>::updateColliders(const real dt)
 {
-	bool dirty = false;
 	for (const auto &collider : _colliders) {
 		auto dynamicCollider = dynamic_cast<DynamicCollider<Dim> *>(collider.get());
 		if (dynamicCollider) {
-			dirty = true;
+			dynamicCollider->advance(dt);
+			const auto [minCorner, maxCorner] = dynamicCollider->sweptBoundingBox();
+			_boundaryHelper->update(_colliders, _domainBoundaryVelocity, minCorner, maxCorner);
 		}
 	}
-	if (dirty) updateBoundary();
 }
 
 template <int Dim>
@@ -1,15 +1,27 @@
 #include "EulerianProjector.h"
 
-#include "Solvers/IterativeSolver.h"
+#include <fmt/core.h>
+
+#include <iostream>
+
+#include <cstdlib>
 
 namespace PhysX {
 
 template <int Dim>
 EulerianProjector<Dim>::EulerianProjector(const Grid<Dim> *const grid) :
 	_reducedPressure(grid),
-	_velocityDiv(grid),
-	_matLaplacian(grid->dataCount(), grid->dataCount())
-{ }
+	_velocityDiv(grid)
+{
+	_micpcgSolver.preconditioner().setGridSize(grid->dataSize());
+}
+
+template <int Dim>
+void EulerianProjector<Dim>::setSolver(const ProjectionSolver solver)
+{
+	if (solver < ProjectionSolver::CG || solver > ProjectionSolver::MICPCG) reportError("invalid linear solver");
+	_solver = solver;
+}
 
 template <int Dim>
 void EulerianProjector<Dim>::project(
@@ -29,6 +41,29 @@ void EulerianProjector<Dim>::project(
 	const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
 	const LevelSet<Dim> &liquidLevelSet,
 	const real surfaceTensionMultiplier)
+{
+	project<LevelSet<Dim>>(velocity, boundaryFraction, boundaryVelocity, liquidLevelSet, surfaceTensionMultiplier);
+}
+
+template <int Dim>
+void EulerianProjector<Dim>::project(
+	StaggeredGridBasedVectorField<Dim> &velocity,
+	const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
+	const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
+	const NarrowBandLevelSet<Dim> &liquidLevelSet,
+	const real surfaceTensionMultiplier)
+{
+	project<NarrowBandLevelSet<Dim>>(velocity, boundaryFraction, boundaryVelocity, liquidLevelSet, surfaceTensionMultiplier);
+}
+
+template <int Dim>
+template <typename LevelSetType>
+void EulerianProjector<Dim>::project(
+	StaggeredGridBasedVectorField<Dim> &velocity,
+	const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
+	const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
+	const LevelSetType &liquidLevelSet,
+	const real surfaceTensionMultiplier)
 {
 	buildLinearSystem(velocity, boundaryFraction, boundaryVelocity, liquidLevelSet, surfaceTensionMultiplier);
 	solveLinearSystem();
@@ -38,10 +73,21 @@ void EulerianProjector<Dim>::project(
 template <int Dim>
 void EulerianProjector<Dim>::solveLinearSystem()
 {
-	IterativeSolver::solve(
-		_matLaplacian,
-		_reducedPressure.asVectorXr(),
-		_velocityDiv.asVectorXr());
+	const auto &matLaplacian = _laplacianAssembler.matrix();
+	switch (_solver) {
+	case ProjectionSolver::CG:
+		IterativeSolver::solve(matLaplacian, _reducedPressure.asVectorXr(), _velocityDiv.asVectorXr());
+		break;
+	case ProjectionSolver::ICPCG:
+		IterativeSolver::solve<SparseAssembler::MatrixType, IterativeSolver::ICPCG<SparseAssembler::MatrixType>>(
+			matLaplacian, _reducedPressure.asVectorXr(), _velocityDiv.asVectorXr());
+		break;
+	case ProjectionSolver::MICPCG:
+		IterativeSolver::solve(_micpcgSolver, matLaplacian, _reducedPressure.asVectorXr(), _velocityDiv.asVectorXr());
+		break;
+	default:
+		reportError("invalid linear solver");
+	}
 }
 
 template <int Dim>
@@ -50,9 +96,9 @@ void EulerianProjector<Dim>::buildLinearSystem(
 	const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
 	const StaggeredGridBasedVectorField<Dim> &boundaryVelocity)
 {
-	_coefficients.clear();
-	_reducedPressure.forEach([&](const VectorDi &cell) {
-		const int idx = int(_reducedPressure.index(cell));
+	const int cnt = int(_reducedPressure.count());
+	_laplacianAssembler.assemble(cnt, cnt, [&](const int idx, SparseAssembler::RowBuilder &row) {
+		const VectorDi cell = _reducedPressure.coordinate(idx);
 		real diagCoeff = 0;
 		real div = 0;
 		for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
@@ -63,7 +109,7 @@ void EulerianProjector<Dim>::buildLinearSystem(
 			const real weight = 1 - boundaryFraction[axis][face];
 			if (weight > 0) {
 				diagCoeff += weight;
-				_coefficients.push_back(Tripletr(idx, int(_reducedPressure.index(nbCell)), -weight));
+				row.add(int(_reducedPressure.index(nbCell)), -weight);
 				div += side * weight * velocity[axis][face];
 			}
 			if (weight < 1)
@@ -71,9 +117,8 @@ void EulerianProjector<Dim>::buildLinearSystem(
 		}
 		if (!diagCoeff) diagCoeff = 1;
 		_velocityDiv[cell] = div;
-		_coefficients.push_back(Tripletr(idx, idx, diagCoeff));
+		row.add(idx, diagCoeff);
 	});
-	_matLaplacian.setFromTriplets(_coefficients.begin(), _coefficients.end());
 }
 
 template <int Dim>
@@ -91,21 +136,20 @@ void EulerianProjector<Dim>::applyPressureGradient(
 }
 
 template <int Dim>
+template <typename LevelSetType>
 void EulerianProjector<Dim>::buildLinearSystem(
 	StaggeredGridBasedVectorField<Dim> &velocity,
 	const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
 	const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
-	const LevelSet<Dim> &liquidLevelSet,
+	const LevelSetType &liquidLevelSet,
 	const real surfaceTensionMultiplier)
 {
-	_coefficients.clear();
-
-	const auto &liquidSdf = liquidLevelSet.signedDistanceField();
-	_reducedPressure.forEach([&](const VectorDi &cell) {
-		const int idx = int(_reducedPressure.index(cell));
+	const int cnt = int(_reducedPressure.count());
+	_laplacianAssembler.assemble(cnt, cnt, [&](const int idx, SparseAssembler::RowBuilder &row) {
+		const VectorDi cell = _reducedPressure.coordinate(idx);
 		real diagCoeff = 0;
 		real div = 0;
-		if (Surface<Dim>::isInside(liquidSdf[cell])) {
+		if (Surface<Dim>::isInside(liquidLevelSet.value(cell))) {
 			for (int i = 0; i < Grid<Dim>::numberOfNeighbors(); i++) {
 				const VectorDi nbCell = Grid<Dim>::neighbor(cell, i);
 				const int axis = StaggeredGrid<Dim>::cellFaceAxis(i);
@@ -113,12 +157,12 @@ void EulerianProjector<Dim>::buildLinearSystem(
 				const VectorDi face = StaggeredGrid<Dim>::cellFace(cell, i);
 				const real weight = 1 - boundaryFraction[axis][face];
 				if (weight > 0) {
-					if (Surface<Dim>::isInside(liquidSdf[nbCell])) {
+					if (Surface<Dim>::isInside(liquidLevelSet.value(nbCell))) {
 						diagCoeff += weight;
-						_coefficients.push_back(Tripletr(idx, int(_reducedPressure.index(nbCell)), -weight));
+						row.add(int(_reducedPressure.index(nbCell)), -weight);
 					}
 					else {
-						const real theta = Surface<Dim>::theta(liquidSdf[cell], liquidSdf[nbCell]);
+						const real theta = Surface<Dim>::theta(liquidLevelSet.value(cell), liquidLevelSet.value(nbCell));
 						const real intfCoef = 1 / std::max(theta, real(0.001));
 						diagCoeff += weight * intfCoef;
 						if (surfaceTensionMultiplier)
@@ -132,25 +176,24 @@ void EulerianProjector<Dim>::buildLinearSystem(
 		}
 		if (!diagCoeff) diagCoeff = 1;
 		_velocityDiv[cell] = div;
-		_coefficients.push_back(Tripletr(idx, idx, diagCoeff));
+		row.add(idx, diagCoeff);
 	});
-	_matLaplacian.setFromTriplets(_coefficients.begin(), _coefficients.end());
 }
 
 template <int Dim>
+template <typename LevelSetType>
 void EulerianProjector<Dim>::applyPressureGradient(
 	StaggeredGridBasedVectorField<Dim> &velocity,
 	const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
-	const LevelSet<Dim> &liquidLevelSet,
+	const LevelSetType &liquidLevelSet,
 	const real surfaceTensionMultiplier) const
 {
-	const auto &liquidSdf = liquidLevelSet.signedDistanceField();
 	velocity.parallelForEach([&](const int axis, const VectorDi &face) {
 		if (boundaryFraction[axis][face] < 1) {
 			const VectorDi cell0 = StaggeredGrid<Dim>::faceAdjacentCell(axis, face, 0);
 			const VectorDi cell1 = StaggeredGrid<Dim>::faceAdjacentCell(axis, face, 1);
-			const real phi0 = liquidSdf[cell0];
-			const real phi1 = liquidSdf[cell1];
+			const real phi0 = liquidLevelSet.value(cell0);
+			const real phi1 = liquidLevelSet.value(cell1);
 			if (Surface<Dim>::isInside(phi0) || Surface<Dim>::isInside(phi1)) {
 				const real intfCoef = 1 / std::max(Surface<Dim>::fraction(phi0, phi1), real(0.001));
 				velocity[axis][face] += (_reducedPressure[cell1] - _reducedPressure[cell0]) * intfCoef;
@@ -165,17 +208,25 @@ void EulerianProjector<Dim>::applyPressureGradient(
 }
 
 template <int Dim>
+template <typename LevelSetType>
 real EulerianProjector<Dim>::getReducedPressureJump(
 	const VectorDi &cell0,
 	const VectorDi &cell1,
 	const real theta,
-	const LevelSet<Dim> &liquidLevelSet,
+	const LevelSetType &liquidLevelSet,
 	const real surfaceTensionMultiplier) const
 {
 	const VectorDr pos = (1 - theta) * _reducedPressure.position(cell0) + theta * _reducedPressure.position(cell1);
 	return liquidLevelSet.curvature(pos) * surfaceTensionMultiplier;
 }
 
+template <int Dim>
+void EulerianProjector<Dim>::reportError(const std::string &msg)
+{
+	std::cerr << fmt::format("Error: [EulerianProjector] encountered {}.", msg) << std::endl;
+	std::exit(-1);
+}
+
 template class EulerianProjector<2>;
 template class EulerianProjector<3>;
 
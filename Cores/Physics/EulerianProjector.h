@@ -2,12 +2,19 @@
 
 #include "Geometries/Collider.h"
 #include "Geometries/LevelSet.h"
+#include "Geometries/NarrowBandLevelSet.h"
+#include "Solvers/IterativeSolver.h"
+#include "Solvers/SparseAssembler.h"
 #include "Structures/GridBasedScalarField.h"
 #include "Structures/StaggeredGridBasedData.h"
 #include "Structures/StaggeredGridBasedVectorField.h"
 
+#include <string>
+
 namespace PhysX {
 
+enum class ProjectionSolver { CG, ICPCG, MICPCG };
+
 template <int Dim>
 class EulerianProjector
 {
@@ -18,8 +25,10 @@ protected:
 	GridBasedScalarField<Dim> _reducedPressure; // reducedPressure = -dt / dx / rho * pressure
 	GridBasedScalarField<Dim> _velocityDiv; // velocityDiv = Div(velocity) * dx
 
-	std::vector<Tripletr> _coefficients;
-	SparseMatrixr _matLaplacian;
+	SparseAssembler _laplacianAssembler;
+
+	ProjectionSolver _solver = ProjectionSolver::CG;
+	IterativeSolver::MICPCG<SparseAssembler::MatrixType, Dim> _micpcgSolver;
 
 public:
 
@@ -29,6 +38,8 @@ public:
 	EulerianProjector &operator=(const EulerianProjector &rhs) = delete;
 	virtual ~EulerianProjector() = default;
 
+	void setSolver(const ProjectionSolver solver);
+
 	void project(
 		StaggeredGridBasedVectorField<Dim> &velocity,
 		const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
@@ -38,6 +49,11 @@ public:
 		const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
 		const LevelSet<Dim> &liquidLevelSet,
 		const real surfaceTensionMultiplier = 0);
+	void project(StaggeredGridBasedVectorField<Dim> &velocity,
+		const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
+		const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
+		const NarrowBandLevelSet<Dim> &liquidLevelSet,
+		const real surfaceTensionMultiplier = 0);
 
 protected:
 
@@ -51,23 +67,37 @@ protected:
 		StaggeredGridBasedVectorField<Dim> &velocity,
 		const StaggeredGridBasedScalarData<Dim> &boundaryFraction) const;
 
+	// The liquid is given by a dense or a narrow-band level set, whose values are sampled at cells.
+	template <typename LevelSetType>
+	void project(
+		StaggeredGridBasedVectorField<Dim> &velocity,
+		const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
+		const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
+		const LevelSetType &liquidLevelSet,
+		const real surfaceTensionMultiplier);
+
+	template <typename LevelSetType>
 	void buildLinearSystem(StaggeredGridBasedVectorField<Dim> &velocity,
 		const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
 		const StaggeredGridBasedVectorField<Dim> &boundaryVelocity,
-		const LevelSet<Dim> &liquidLevelSet,
+		const LevelSetType &liquidLevelSet,
 		const real surfaceTensionMultiplier);
+	template <typename LevelSetType>
 	void applyPressureGradient(
 		StaggeredGridBasedVectorField<Dim> &velocity,
 		const StaggeredGridBasedScalarData<Dim> &boundaryFraction,
-		const LevelSet<Dim> &liquidLevelSet,
+		const LevelSetType &liquidLevelSet,
 		const real surfaceTensionMultiplier) const;
 
+	template <typename LevelSetType>
 	real getReducedPressureJump(
 		const VectorDi &cell0,
 		const VectorDi &cell1,
 		const real theta,
-		const LevelSet<Dim> &liquidLevelSet,
+		const LevelSetType &liquidLevelSet,
 		const real surfaceTensionMultiplier) const;
+
+	static void reportError(const std::string &msg);
 };
 
 }
@@ -1,5 +1,8 @@
 #include "FlImplicitParticleLiquid.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
 #include <numbers>
 
 namespace PhysX {
@@ -8,56 +11,131 @@ template <int Dim>
 FlImplicitParticleLiquid<Dim>::FlImplicitParticleLiquid(const StaggeredGrid<Dim> &grid, const int markersCntPerSubcell, const real propOfPic) :
 	ParticleInCellLiquid<Dim>(grid, markersCntPerSubcell),
 	_propOfPic(std::clamp(propOfPic, real(0), real(1))),
-	_deltaVelocity(&_grid)
+	_deltaVelocity(&_grid),
+	_interiorVelocity(&_grid)
 { }
 
 template <int Dim>
-void FlImplicitParticleLiquid<Dim>::saveFrame(const std::string &frameDir) const
+void FlImplicitParticleLiquid<Dim>::saveFrame(FrameBuffer &frame) const
 {
-	ParticleInCellLiquid<Dim>::saveFrame(frameDir);
+	ParticleInCellLiquid<Dim>::saveFrame(frame);
+	// The interior of the liquid is not outlined by particles.
+	if (_particlesBandWidth) this->saveLevelSet(frame);
 	{ // Save particleVelocities.
-		std::ofstream fout(frameDir + "/particleVelocities.sav", std::ios::binary);
+		auto &fout = frame.open("particleVelocities.sav");
 		_particleVelocities.save(fout);
 	}
 	{ // Save deltaVelocity.
-		std::ofstream fout(frameDir + "/deltaVelocity.sav", std::ios::binary);
+		auto &fout = frame.open("deltaVelocity.sav");
 		_deltaVelocity.save(fout);
 	}
 }
 
 template <int Dim>
-void FlImplicitParticleLiquid<Dim>::loadFrame(const std::string &frameDir)
+void FlImplicitParticleLiquid<Dim>::loadFrame(const ArchivedFrame &frame)
 {
-	ParticleInCellLiquid<Dim>::loadFrame(frameDir);
+	ParticleInCellLiquid<Dim>::loadFrame(frame);
+	if (_particlesBandWidth) this->loadLevelSet(frame);
 	{ // Load particleVelocities.
-		std::ifstream fin(frameDir + "/particleVelocities.sav", std::ios::binary);
+		auto fin = frame.open("particleVelocities.sav");
 		_particleVelocities.load(fin);
 	}
 	{ // Load deltaVelocity.
-		std::ifstream fin(frameDir + "/deltaVelocity.sav", std::ios::binary);
+		auto fin = frame.open("deltaVelocity.sav");
 		_deltaVelocity.load(fin);
 	}
 }
 
+template <int Dim>
+void FlImplicitParticleLiquid<Dim>::advectFields(const real dt)
+{
+	if (!_particlesBandWidth) {
+		ParticleInCellLiquid<Dim>::advectFields(dt);
+		return;
+	}
+
+	// Move the band along with the surface before advecting particles.
+	this->controlParticlesPopulation(particlesBandWidth());
+	ParticleInCellLiquid<Dim>::advectFields(dt);
+
+	if (_narrowBandLevelSet) _advector->advect(*_narrowBandLevelSet, _velocity, dt);
+	else _advector->advect(_levelSet.signedDistanceField(), _velocity, dt);
+
+	EulerianFluid<Dim>::advectFields(dt);
+	_interiorVelocity = _velocity;
+}
+
 template <int Dim>
 void FlImplicitParticleLiquid<Dim>::transferFromGridToParticles()
 {
 	_deltaVelocity.parallelForEach([&](const int axis, const VectorDi &face) {
 		_deltaVelocity[axis][face] = _velocity[axis][face] - _deltaVelocity[axis][face];
 	});
-	_particles.parallelForEach([&](const int i) {
-		const VectorDr &pos = _particles.positions[i];
-		_particleVelocities[i] = _propOfPic * _velocity(pos) + (1 - _propOfPic) * (_particleVelocities[i] + _deltaVelocity(pos));
-	});
+	const int cnt = int(_particles.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int begin = 0; begin < cnt; begin += _kBatchSize) {
+		const int batchCnt = std::min(cnt - begin, _kBatchSize);
+		std::array<VectorDr, _kBatchSize> picVel, deltaVel;
+		_velocity.interpolate(_particles.positions.data() + begin, picVel.data(), batchCnt);
+		_deltaVelocity.interpolate(_particles.positions.data() + begin, deltaVel.data(), batchCnt);
+		for (int i = 0; i < batchCnt; i++) {
+			VectorDr &vel = _particleVelocities[begin + i];
+			vel = _propOfPic * picVel[i] + (1 - _propOfPic) * (vel + deltaVel[i]);
+		}
+	}
 }
 
 template <int Dim>
 void FlImplicitParticleLiquid<Dim>::maintainGridBasedData(StaggeredGridBasedScalarData<Dim> &weightSum)
 {
+	if (_particlesBandWidth) {
+		// Faces in the liquid receiving no particles take the velocities advected on the grid. The level set is still the
+		// advected one here, since it is only rebuilt from particles below.
+		_velocity.parallelForEach([&](const int axis, const VectorDi &face) {
+			if (!weightSum[axis][face] && Surface<Dim>::isInside(liquidSurface().signedDistance(_velocity[axis].position(face)))) {
+				_velocity[axis][face] = _interiorVelocity[axis][face];
+				weightSum[axis][face] = 1;
+			}
+		});
+	}
 	_deltaVelocity = _velocity;
 	ParticleInCellLiquid<Dim>::maintainGridBasedData(weightSum);
 }
 
+template <int Dim>
+void FlImplicitParticleLiquid<Dim>::resetLevelSet()
+{
+	if (!_particlesBandWidth) {
+		ParticleInCellLiquid<Dim>::resetLevelSet();
+		return;
+	}
+
+	// The particles only outline the band, inside which the level set advected on the grid takes over, so the particles
+	// are splatted into what is left of it. The switch lies between the inner boundary of the band and that of the
+	// particles, so that no spurious interface arises.
+	const real threshold = _grid.spacing() - _particlesBandWidth;
+	if (_narrowBandLevelSet) {
+		const real bandWidth = _narrowBandLevelSet->bandWidth();
+		_narrowBandLevelSet->remap([&](const real phi) { return phi < threshold ? phi : bandWidth; });
+	}
+	else {
+		auto &liquidSdf = _levelSet.signedDistanceField();
+		liquidSdf.parallelForEach([&](const VectorDi &cell) {
+			if (liquidSdf[cell] >= threshold)
+				liquidSdf[cell] = std::numeric_limits<real>::infinity();
+		});
+	}
+}
+
+template <int Dim>
+void FlImplicitParticleLiquid<Dim>::reinitializeParticles()
+{
+	ParticleInCellLiquid<Dim>::reinitializeParticles();
+	if (_particlesBandWidth) this->controlParticlesPopulation(particlesBandWidth());
+}
+
 template class FlImplicitParticleLiquid<2>;
 template class FlImplicitParticleLiquid<3>;
 
@@ -10,16 +10,29 @@ class FlImplicitParticleLiquid : public ParticleInCellLiquid<Dim>
 {
 	DECLARE_DIM_TYPES(Dim)
 
+public:
+
+	friend class ParticleInCellLiquidBuilder;
+
 protected:
 
 	using EulerianFluid<Dim>::_grid;
 	using EulerianFluid<Dim>::_velocity;
+	using EulerianFluid<Dim>::_advector;
+	using LevelSetLiquid<Dim>::_levelSet;
+	using LevelSetLiquid<Dim>::_narrowBandLevelSet;
+	using ParticleInCellLiquid<Dim>::_kBatchSize;
 	using ParticleInCellLiquid<Dim>::_particles;
 	using ParticleInCellLiquid<Dim>::_particleVelocities;
 
 	const real _propOfPic;
 	StaggeredGridBasedVectorField<Dim> _deltaVelocity;
 
+	// Narrow-band FLIP [Ferstl et al. 2016]. If the band width is positive, particles are only kept within it beneath
+	// the surface, and the deep interior is represented by the level set and velocity advected on the grid.
+	real _particlesBandWidth = 0;
+	StaggeredGridBasedVectorField<Dim> _interiorVelocity;
+
 public:
 
 	FlImplicitParticleLiquid(const StaggeredGrid<Dim> &grid, const int markersCntPerSubcell, const real propOfPic);
@@ -28,14 +41,21 @@ public:
 	FlImplicitParticleLiquid &operator=(const FlImplicitParticleLiquid &rhs) = delete;
 	virtual ~FlImplicitParticleLiquid() = default;
 
-	virtual void saveFrame(const std::string &frameDir) const override;
-	virtual void loadFrame(const std::string &frameDir) override;
+	virtual void saveFrame(FrameBuffer &frame) const override;
+	virtual void loadFrame(const ArchivedFrame &frame) override;
 
 protected:
 
+	using LevelSetLiquid<Dim>::liquidSurface;
+
+	virtual void advectFields(const real dt) override;
 	virtual void transferFromGridToParticles() override;
 
 	virtual void maintainGridBasedData(StaggeredGridBasedScalarData<Dim> &weightSum) override;
+	virtual void resetLevelSet() override;
+	virtual void reinitializeParticles() override;
+
+	virtual real particlesBandWidth() const override { return _particlesBandWidth ? _particlesBandWidth : ParticleInCellLiquid<Dim>::particlesBandWidth(); }
 };
 
 }
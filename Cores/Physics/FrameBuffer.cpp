@@ -0,0 +1,51 @@
+#include "FrameBuffer.h"
+
+#include <algorithm>
+
+namespace PhysX {
+
+void FrameBuffer::clear()
+{
+	for (size_t i = 0; i < _fileCnt; i++) {
+		// Take the string out and put it back empty, which keeps its capacity.
+		std::string bytes = std::move(*_streams[i]).str();
+		bytes.clear();
+		_streams[i]->str(std::move(bytes));
+		_streams[i]->clear();
+	}
+	_fileCnt = 0;
+}
+
+std::ostream &FrameBuffer::open(const std::string &name)
+{
+	if (_fileCnt == _streams.size()) {
+		_names.push_back(name);
+		_streams.push_back(std::make_unique<std::ostringstream>(std::ios::binary));
+	}
+	else _names[_fileCnt] = name;
+	return *_streams[_fileCnt++];
+}
+
+void FrameBuffer::appendTo(FrameArchiveWriter &archive, const uint frame) const
+{
+	std::vector<std::pair<std::string_view, std::string_view>> sections(_fileCnt);
+	for (size_t i = 0; i < _fileCnt; i++)
+		sections[i] = { _names[i], _streams[i]->view() };
+	archive.append(frame, sections);
+}
+
+void FrameBuffer::writeHeatRange(const std::ostream &out)
+{
+	if (_heats.empty()) return;
+	const auto end = _streams.begin() + _fileCnt;
+	const auto iter = std::find_if(_streams.begin(), end, [&](const auto &stream) { return stream.get() == &out; });
+	if (iter == end) return;
+	const std::string &meshName = _names[iter - _streams.begin()];
+	const std::string name = meshName.substr(0, meshName.rfind('.')) + ".heat_range";
+	const auto minmax = std::minmax_element(_heats.begin(), _heats.end());
+	auto &fout = open(name);
+	IO::writeValue(fout, *minmax.first);
+	IO::writeValue(fout, *minmax.second);
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Utilities/FrameArchive.h"
+#include "Utilities/IO.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace PhysX {
+
+// In-memory files of a frame, which are written by a simulation and appended to a frame archive later.
+// Streams are kept across frames, so their storage is reused once it has grown large enough.
+class FrameBuffer
+{
+protected:
+
+	std::vector<std::string> _names;
+	std::vector<std::unique_ptr<std::ostringstream>> _streams;
+	size_t _fileCnt = 0;
+	std::vector<float> _heats;
+
+public:
+
+	FrameBuffer() = default;
+	FrameBuffer(const FrameBuffer &rhs) = delete;
+	FrameBuffer &operator=(const FrameBuffer &rhs) = delete;
+	virtual ~FrameBuffer() = default;
+
+	void clear();
+	std::ostream &open(const std::string &name);
+	void appendTo(FrameArchiveWriter &archive, const uint frame) const;
+
+	// Writes cnt heats given by func to the mesh file out, as IO::writeMapped does. Their range is written as well, to
+	// a file of two floats named after the mesh, such as "particles.heat_range", so that the viewer gets the range of
+	// all frames without reading their heats.
+	template <typename Func>
+	void writeHeats(std::ostream &out, const size_t cnt, Func &&func)
+	{
+		_heats.resize(cnt);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < int(cnt); i++) _heats[i] = func(i);
+		IO::writeArray(out, _heats.data(), cnt);
+		writeHeatRange(out);
+	}
+
+protected:
+
+	void writeHeatRange(const std::ostream &out);
+};
+
+}
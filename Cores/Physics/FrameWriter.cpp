@@ -0,0 +1,102 @@
+#include "FrameWriter.h"
+
+#include "Utilities/MappedFile.h"
+
+#include <fmt/core.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace PhysX {
+
+FrameWriter::FrameWriter(const std::string &outputDir, const bool resume) :
+	_outputDir(outputDir)
+{
+	_archive.open(_outputDir + "/" + FrameArchive::kFileName, resume);
+	for (auto &buffer : _buffers) _freeBuffers.push_back(&buffer);
+	_thread = std::thread(&FrameWriter::run, this);
+}
+
+FrameWriter::~FrameWriter()
+{
+	{
+		std::lock_guard lock(_mutex);
+		_stopping = true;
+	}
+	_frameSubmitted.notify_one();
+	_thread.join();
+}
+
+FrameBuffer &FrameWriter::acquire()
+{
+	std::unique_lock lock(_mutex);
+	_bufferReleased.wait(lock, [&] { return !_freeBuffers.empty(); });
+	_acquiredBuffer = _freeBuffers.back();
+	_freeBuffers.pop_back();
+	lock.unlock();
+
+	_acquiredBuffer->clear();
+	return *_acquiredBuffer;
+}
+
+void FrameWriter::submit(const uint frame)
+{
+	{
+		std::lock_guard lock(_mutex);
+		_pendingFrames.push_back({ frame, _acquiredBuffer });
+		_acquiredBuffer = nullptr;
+	}
+	_frameSubmitted.notify_one();
+}
+
+void FrameWriter::finish()
+{
+	std::unique_lock lock(_mutex);
+	_bufferReleased.wait(lock, [&] { return _freeBuffers.size() == _kMaxPendingFrames; });
+}
+
+void FrameWriter::run()
+{
+	std::unique_lock lock(_mutex);
+	while (true) {
+		_frameSubmitted.wait(lock, [&] { return _stopping || !_pendingFrames.empty(); });
+		if (_pendingFrames.empty()) break;
+		const auto [frame, buffer] = _pendingFrames.front();
+		lock.unlock();
+
+		buffer->appendTo(_archive, frame);
+		writeEndFrame(frame + 1);
+
+		lock.lock();
+		_pendingFrames.pop_front();
+		_freeBuffers.push_back(buffer);
+		_bufferReleased.notify_all();
+	}
+}
+
+void FrameWriter::writeEndFrame(const uint endFrame) const
+{
+	// The file is replaced at once, so that it never holds a partially written number or runs ahead of the archive.
+	const std::string fileName = _outputDir + "/end_frame.txt";
+	const std::string tempFileName = fileName + ".tmp";
+	{
+		std::ofstream fout(tempFileName);
+		fout << endFrame << std::endl;
+		if (!fout) reportError(fmt::format("failed to write {}", tempFileName));
+	}
+	if (!syncFile(tempFileName)) reportError(fmt::format("failed to sync {}", tempFileName));
+	std::error_code error;
+	std::filesystem::rename(tempFileName, fileName, error);
+	if (error) reportError(fmt::format("failed to rename {} to {}", tempFileName, fileName));
+}
+
+void FrameWriter::reportError(const std::string &msg)
+{
+	std::cerr << fmt::format("Error: [FrameWriter] {}.", msg) << std::endl;
+	std::exit(-1);
+}
+
+}
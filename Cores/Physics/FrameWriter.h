@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Physics/FrameBuffer.h"
+#include "Utilities/Types.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace PhysX {
+
+// Appends frame buffers to the frame archive of the output directory on a background thread.
+//
+// At most _kMaxPendingFrames frames are pending, beyond which acquiring a buffer waits for the oldest one. Frames are
+// appended in the order of submission, and end_frame.txt is advanced only after a frame is synced to the archive.
+class FrameWriter
+{
+protected:
+
+	static constexpr size_t _kMaxPendingFrames = 2;
+
+	const std::string _outputDir;
+	FrameArchiveWriter _archive;
+
+	FrameBuffer _buffers[_kMaxPendingFrames];
+	std::vector<FrameBuffer *> _freeBuffers;
+	std::deque<std::pair<uint, FrameBuffer *>> _pendingFrames;
+	FrameBuffer *_acquiredBuffer = nullptr;
+
+	std::mutex _mutex;
+	std::condition_variable _bufferReleased;
+	std::condition_variable _frameSubmitted;
+	bool _stopping = false;
+
+	std::thread _thread;
+
+public:
+
+	FrameWriter(const std::string &outputDir, const bool resume);
+
+	FrameWriter(const FrameWriter &rhs) = delete;
+	FrameWriter &operator=(const FrameWriter &rhs) = delete;
+	virtual ~FrameWriter();
+
+	FrameBuffer &acquire();
+	void submit(const uint frame);
+	void finish();
+
+protected:
+
+	void run();
+	void writeEndFrame(const uint endFrame) const;
+
+	static void reportError(const std::string &msg);
+};
+
+}
@@ -0,0 +1,157 @@
+#include "ImplicitIncomprSphLiquid.h"
+
+#include <algorithm>
+
+namespace PhysX {
+
+    template<int Dim> real ImplicitIncomprSphLiquid<Dim>::getTimeStep(const uint frameRate, const real stepRate) const {
+        return std::min(SmthParticleHydrodLiquid<Dim>::getTimeStep(frameRate, stepRate), _kMaxTimeStep);
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::advance(const real dt) {
+        applyExternalForces(dt);
+        applyViscosityForce(dt);
+        applyPressureForce(dt);
+        moveParticles(dt);
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::reinitializeParticlesBasedData() {
+        SmthParticleHydrodLiquid<Dim>::reinitializeParticlesBasedData();
+        _displacementCoeffs.resize(&_particles);
+        _diagonals.resize(&_particles);
+        _advectedDensities.resize(&_particles);
+        _displacements.resize(&_particles);
+        _newPressures.resize(&_particles);
+        _densityErrors.resize(&_particles);
+
+        _particles.resetNearbySearcher();
+        _particles.computeDensities();
+        cacheNeighbors();
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::moveParticles(const real dt) {
+        SmthParticleHydrodLiquid<Dim>::moveParticles(dt);
+        cacheNeighbors();
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::applyPressureForce(const real dt) {
+        resolveCollisions(dt);
+        predictAdvection(dt);
+        solvePressures(dt);
+
+        computeDisplacements(dt);
+        _particles.parallelForEach([&](const int i) { _velocities[i] += _displacements[i] / dt; });
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::cacheNeighbors() {
+        const int cnt = int(_particles.size());
+        _neighborOffsets.resize(size_t(cnt) + 1);
+        _neighborOffsets[0] = 0;
+        _particles.parallelForEach([&](const int i) {
+            int nbCnt = 0;
+            _particles.forEachNearby(_particles.positions[i], [&](const int j, const VectorDr &) {
+                if (j != i) nbCnt++;
+            });
+            _neighborOffsets[size_t(i) + 1] = nbCnt;
+        });
+        for (int i = 0; i < cnt; i++) _neighborOffsets[size_t(i) + 1] += _neighborOffsets[i];
+
+        _neighbors.resize(_neighborOffsets[cnt]);
+        _neighborGradients.resize(_neighborOffsets[cnt]);
+        _particles.parallelForEach([&](const int i) {
+            const VectorDr pos_i = _particles.positions[i];
+            int            k     = _neighborOffsets[i];
+            _particles.forEachNearby(pos_i, [&](const int j, const VectorDr & pos_j) {
+                if (j == i) return;
+                _neighbors[k]           = j;
+                _neighborGradients[k++] = _particles.gradientKernel(pos_j - pos_i);
+            });
+        });
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::resolveCollisions(const real dt) {
+        // Colliders are not sampled by particles, so velocities heading into them are resolved at predicted positions
+        // before the pressure solve, which would otherwise relieve compression by pushing particles into colliders.
+        _particles.parallelForEach([&](const int i) {
+            const VectorDr predPos = _particles.positions[i] + _velocities[i] * dt;
+            for (const auto & collider : _colliders)
+                if (collider->detect(predPos, _particles.radius())) collider->resolve(predPos, _velocities[i]);
+        });
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::predictAdvection(const real dt) {
+        const real mass = _particles.mass();
+        _particles.parallelForEach([&](const int i) {
+            const real coeff = dt * dt * mass / (_particles.densities[i] * _particles.densities[i]);
+            VectorDr   sum   = VectorDr::Zero();
+            real       rate  = 0;
+            forEachNeighbor(i, [&](const int j, const VectorDr & grad) {
+                sum += grad;
+                rate += (_velocities[i] - _velocities[j]).dot(grad);
+            });
+            _displacementCoeffs[i] = -coeff * sum;
+            _advectedDensities[i]  = _particles.densities[i] + rate * mass * dt;
+
+            // d_ji = dt^2 * m_i / rho_i^2 * grad W_ij, as grad W_ji = -grad W_ij.
+            real diagonal = 0;
+            forEachNeighbor(i, [&](const int, const VectorDr & grad) {
+                diagonal += (_displacementCoeffs[i] - coeff * grad).dot(grad);
+            });
+            _diagonals[i] = diagonal * mass;
+
+            // Only a part of the last pressures is reused, which would otherwise keep pushing parted particles.
+            _pressures[i] = _diagonals[i] ? _pressures[i] * _kWarmStartRatio : 0;
+        });
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::solvePressures(const real dt) {
+        for (int iter = 0; iter < _kMaxIters; iter++) {
+            computeDisplacements(dt);
+
+            // Summing the difference of displacements over neighbors gives a_ii * p_i plus the off-diagonal terms.
+            _particles.parallelForEach([&](const int i) {
+                real sum = 0;
+                forEachNeighbor(i, [&](const int j, const VectorDr & grad) {
+                    sum += (_displacements[i] - _displacements[j]).dot(grad);
+                });
+                const real density = _advectedDensities[i] + sum * _particles.mass();
+                // Relaxed Jacobi, projected to non-negative pressures so that the free surface is left alone.
+                if (_diagonals[i]) {
+                    const real pressure = _pressures[i] + _kRelaxation * (_targetDensity - density) / _diagonals[i];
+                    _newPressures[i]    = std::max(pressure, real(0));
+                }
+                else _newPressures[i] = 0;
+                _densityErrors[i] = _newPressures[i] ? density - _targetDensity : 0;
+            });
+
+            _particles.parallelForEach([&](const int i) { _pressures[i] = _newPressures[i]; });
+
+            real sumOfErrors = 0;
+            _particles.forEach([&](const int i) { sumOfErrors += std::max(_densityErrors[i], real(0)); });
+            if (iter + 1 >= _kMinIters && sumOfErrors <= _kDensityErrorRatio * _targetDensity * _particles.size())
+                break;
+        }
+    }
+
+    template<int Dim> void ImplicitIncomprSphLiquid<Dim>::computeDisplacements(const real dt) {
+        const real mass = _particles.mass();
+        _particles.parallelForEach([&](const int i) {
+            VectorDr sum = VectorDr::Zero();
+            forEachNeighbor(i, [&](const int j, const VectorDr & grad) {
+                sum += _pressures[j] / (_particles.densities[j] * _particles.densities[j]) * grad;
+            });
+            _displacements[i] = _displacementCoeffs[i] * _pressures[i] - dt * dt * mass * sum;
+
+            // Colliders are not sampled by particles, so displacements into them are resolved in every iteration.
+            VectorDr       vel     = _velocities[i] + _displacements[i] / dt;
+            const VectorDr predPos = _particles.positions[i] + vel * dt;
+            for (const auto & collider : _colliders)
+                if (collider->detect(predPos, _particles.radius()) && collider->resolve(predPos, vel))
+                    _displacements[i] = (vel - _velocities[i]) * dt;
+        });
+    }
+
+    template class ImplicitIncomprSphLiquid<2>;
+    template class ImplicitIncomprSphLiquid<3>;
+
+} // namespace PhysX
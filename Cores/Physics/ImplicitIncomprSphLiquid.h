@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Physics/SmthParticleHydrodLiquid.h"
+
+#include <vector>
+
+namespace PhysX {
+
+    // Implicit incompressible SPH [Ihmsen et al. 2014].
+    //
+    // The pressure Poisson equation is solved by relaxed Jacobi iterations on pressures, with the diagonal a_ii and the
+    // displacement coefficients d_ii computed once per step. Each iteration first sums the displacements by pressures,
+    // d_ii * p_i + sum of d_ij * p_j, and then the density changes by them, so both passes are linear in neighbors.
+    // Neighbor lists and kernel gradients are cached after particles move, so that iterations never search again.
+    template<int Dim> class ImplicitIncomprSphLiquid : public SmthParticleHydrodLiquid<Dim> {
+        DECLARE_DIM_TYPES(Dim)
+
+    protected:
+        using SmthParticleHydrodLiquid<Dim>::_colliders;
+        using SmthParticleHydrodLiquid<Dim>::_particles;
+        using SmthParticleHydrodLiquid<Dim>::_velocities;
+        using SmthParticleHydrodLiquid<Dim>::_pressures;
+        using SmthParticleHydrodLiquid<Dim>::_targetDensity;
+
+        static constexpr int  _kMaxIters          = 100;
+        static constexpr int  _kMinIters          = 2;
+        static constexpr real _kRelaxation        = real(.5);
+        static constexpr real _kWarmStartRatio    = real(.5);
+        static constexpr real _kDensityErrorRatio = real(.001); // of the average density error to the target
+        static constexpr real _kMaxTimeStep       = real(1e-2);
+
+        // Neighbors of particle i, excluding itself, are _neighbors[_neighborOffsets[i], _neighborOffsets[i + 1]).
+        std::vector<int>      _neighborOffsets;
+        std::vector<int>      _neighbors;
+        std::vector<VectorDr> _neighborGradients; // gradients of kernels with respect to particle i
+
+        ParticlesBasedVectorData<Dim> _displacementCoeffs;     // d_ii
+        ParticlesBasedScalarData<Dim> _diagonals;              // a_ii
+        ParticlesBasedScalarData<Dim> _advectedDensities;      // densities predicted without pressures
+        ParticlesBasedVectorData<Dim> _displacements;          // d_ii * p_i + sum of d_ij * p_j
+        ParticlesBasedScalarData<Dim> _newPressures;
+        ParticlesBasedScalarData<Dim> _densityErrors;
+
+    public:
+        ImplicitIncomprSphLiquid(const real particleRadius): SmthParticleHydrodLiquid<Dim>(particleRadius) {}
+
+        ImplicitIncomprSphLiquid(const ImplicitIncomprSphLiquid & rhs)             = delete;
+        ImplicitIncomprSphLiquid & operator=(const ImplicitIncomprSphLiquid & rhs) = delete;
+        virtual ~ImplicitIncomprSphLiquid()                                        = default;
+
+        virtual real getTimeStep(const uint frameRate, const real stepRate) const override;
+
+        virtual void advance(const real dt) override;
+
+    protected:
+        using SmthParticleHydrodLiquid<Dim>::applyExternalForces;
+        using SmthParticleHydrodLiquid<Dim>::applyViscosityForce;
+
+        virtual void reinitializeParticlesBasedData() override;
+        virtual void moveParticles(const real dt) override;
+        virtual void applyPressureForce(const real dt) override;
+
+        void cacheNeighbors();
+        void resolveCollisions(const real dt);
+        void predictAdvection(const real dt);
+        void solvePressures(const real dt);
+        void computeDisplacements(const real dt);
+
+        template<typename Func> void forEachNeighbor(const int i, Func && func) const {
+            for (int k = _neighborOffsets[i]; k < _neighborOffsets[i + 1]; k++)
+                func(_neighbors[k], _neighborGradients[k]);
+        }
+    };
+
+} // namespace PhysX
@@ -39,43 +39,40 @@ void LevelSetLiquid<Dim>::writeDescription(YAML::Node &root) const
 }
 
 template <int Dim>
-void LevelSetLiquid<Dim>::writeFrame(const std::string &frameDir, const bool staticDraw) const
+void LevelSetLiquid<Dim>::writeFrame(FrameBuffer &frame, const bool staticDraw) const
 {
-	EulerianFluid<Dim>::writeFrame(frameDir, staticDraw);
+	EulerianFluid<Dim>::writeFrame(frame, staticDraw);
 	{ // Write liquid.
-		std::ofstream fout(frameDir + "/liquid.mesh", std::ios::binary);
-		SurfaceMesh<Dim> liquidMesh(_levelSet);
-		IO::writeValue(fout, uint(liquidMesh.positions.size()));
-		for (const auto &pos : liquidMesh.positions)
-			IO::writeValue(fout, pos.template cast<float>().eval());
-		if constexpr (Dim == 3) {
-			for (const auto &normal : liquidMesh.normals)
-				IO::writeValue(fout, normal.template cast<float>().eval());
-		}
-		IO::writeValue(fout, uint(liquidMesh.indices.size()));
-		IO::writeArray(fout, liquidMesh.indices.data(), liquidMesh.indices.size());
+		auto &fout = frame.open("liquid.mesh");
+		visitDenseLevelSet([&](const LevelSet<Dim> &levelSet) {
+			SurfaceMesh<Dim> liquidMesh(levelSet);
+			IO::writeValue(fout, uint(liquidMesh.positions.size()));
+			IO::writeCast<float>(fout, liquidMesh.positions);
+			if constexpr (Dim == 3) IO::writeCast<float>(fout, liquidMesh.normals);
+			IO::writeValue(fout, uint(liquidMesh.indices.size()));
+			IO::writeArray(fout, liquidMesh.indices.data(), liquidMesh.indices.size());
+		});
 	}
 }
 
 template <int Dim>
-void LevelSetLiquid<Dim>::saveFrame(const std::string &frameDir) const
+void LevelSetLiquid<Dim>::saveFrame(FrameBuffer &frame) const
 {
-	EulerianFluid<Dim>::saveFrame(frameDir);
-	std::ofstream fout(frameDir + "/liquidSdf.sav", std::ios::binary);
-	_levelSet.signedDistanceField().save(fout);
+	EulerianFluid<Dim>::saveFrame(frame);
+	saveLevelSet(frame);
 }
 
 template <int Dim>
-void LevelSetLiquid<Dim>::loadFrame(const std::string &frameDir)
+void LevelSetLiquid<Dim>::loadFrame(const ArchivedFrame &frame)
 {
-	EulerianFluid<Dim>::loadFrame(frameDir);
-	std::ifstream fin(frameDir + "/liquidSdf.sav", std::ios::binary);
-	_levelSet.signedDistanceField().load(fin);
+	EulerianFluid<Dim>::loadFrame(frame);
+	loadLevelSet(frame);
 }
 
 template <int Dim>
 void LevelSetLiquid<Dim>::initialize()
 {
+	if (_narrowBandLevelSet) moveLevelSetIntoNarrowBand();
 	reinitializeLevelSet();
 	EulerianFluid<Dim>::initialize();
 }
@@ -83,7 +80,8 @@ void LevelSetLiquid<Dim>::initialize()
 template <int Dim>
 void LevelSetLiquid<Dim>::advectFields(const real dt)
 {
-	_advector->advect(_levelSet.signedDistanceField(), _velocity, dt);
+	if (_narrowBandLevelSet) _advector->advect(*_narrowBandLevelSet, _velocity, dt);
+	else _advector->advect(_levelSet.signedDistanceField(), _velocity, dt);
 	reinitializeLevelSet();
 
 	EulerianFluid<Dim>::advectFields(dt);
@@ -104,19 +102,45 @@ void LevelSetLiquid<Dim>::applyBodyForces(const real dt)
 template <int Dim>
 void LevelSetLiquid<Dim>::projectVelocity(const real dt)
 {
-	if (_enableSurfaceTension && dt)
-		_projector->project(_velocity, _boundaryHelper->fraction(), _boundaryHelper->velocity(), _levelSet, _surfaceTensionCoefficient * dt / _density * _velocity.invSpacing());
-	else
-		_projector->project(_velocity, _boundaryHelper->fraction(), _boundaryHelper->velocity(), _levelSet);
-
-	_boundaryHelper->extrapolate(_velocity, _levelSet, _kExtrapMaxSteps);
+	visitLevelSet([&](const auto &liquidLevelSet) {
+		if (_enableSurfaceTension && dt)
+			_projector->project(_velocity, _boundaryHelper->fraction(), _boundaryHelper->velocity(), liquidLevelSet, _surfaceTensionCoefficient * dt / _density * _velocity.invSpacing());
+		else
+			_projector->project(_velocity, _boundaryHelper->fraction(), _boundaryHelper->velocity(), liquidLevelSet);
+
+		_boundaryHelper->extrapolate(_velocity, liquidLevelSet, _kExtrapMaxSteps);
+	});
 	_boundaryHelper->enforce(_velocity);
 }
 
 template <int Dim>
 void LevelSetLiquid<Dim>::reinitializeLevelSet()
 {
-	_levelSetReinitializer->reinitialize(_levelSet, _kLsReinitMaxSteps);
+	if (_narrowBandLevelSet) _narrowBandLevelSet->reinitialize();
+	else _levelSetReinitializer->reinitialize(_levelSet, _kLsReinitMaxSteps);
+}
+
+template <int Dim>
+void LevelSetLiquid<Dim>::saveLevelSet(FrameBuffer &frame) const
+{
+	auto &fout = frame.open("liquidSdf.sav");
+	visitDenseLevelSet([&](const LevelSet<Dim> &levelSet) { levelSet.signedDistanceField().save(fout); });
+}
+
+template <int Dim>
+void LevelSetLiquid<Dim>::loadLevelSet(const ArchivedFrame &frame)
+{
+	auto fin = frame.open("liquidSdf.sav");
+	_levelSet.signedDistanceField().resize(_grid.cellGrid());
+	_levelSet.signedDistanceField().load(fin);
+	if (_narrowBandLevelSet) moveLevelSetIntoNarrowBand();
+}
+
+template <int Dim>
+void LevelSetLiquid<Dim>::moveLevelSetIntoNarrowBand()
+{
+	_narrowBandLevelSet->assign(_levelSet);
+	GridBasedScalarField<Dim>().swap(_levelSet.signedDistanceField());
 }
 
 template class LevelSetLiquid<2>;
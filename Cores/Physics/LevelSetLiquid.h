@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Geometries/LevelSetReinitializer.h"
+#include "Geometries/NarrowBandLevelSet.h"
 #include "Physics/EulerianFluid.h"
 
+#include <utility>
+
 namespace PhysX {
 
 template <int Dim>
@@ -29,6 +32,7 @@ protected:
 	LevelSet<Dim> _levelSet;
 
 	std::unique_ptr<LevelSetReinitializer<Dim>> _levelSetReinitializer;
+	std::unique_ptr<NarrowBandLevelSet<Dim>> _narrowBandLevelSet; // if set, _levelSet is released once moved into it
 
 	bool _enableGravity = true;
 	bool _enableSurfaceTension = false;
@@ -45,9 +49,9 @@ public:
 	virtual ~LevelSetLiquid() = default;
 
 	virtual void writeDescription(YAML::Node &root) const override;
-	virtual void writeFrame(const std::string & frameDir, const bool staticDraw) const override;
-	virtual void saveFrame(const std::string & frameDir) const override;
-	virtual void loadFrame(const std::string & frameDir) override;
+	virtual void writeFrame(FrameBuffer & frame, const bool staticDraw) const override;
+	virtual void saveFrame(FrameBuffer & frame) const override;
+	virtual void loadFrame(const ArchivedFrame & frame) override;
 
 	virtual void initialize() override;
 
@@ -58,6 +62,35 @@ protected:
 	virtual void projectVelocity(const real dt = 0) override;
 
 	virtual void reinitializeLevelSet();
+
+	void saveLevelSet(FrameBuffer &frame) const;
+	void loadLevelSet(const ArchivedFrame &frame);
+	// Moves _levelSet into the narrow band, which is the only storage of the level set from then on.
+	void moveLevelSetIntoNarrowBand();
+
+	const ImplicitSurface<Dim> &liquidSurface() const { return _narrowBandLevelSet ? static_cast<const ImplicitSurface<Dim> &>(*_narrowBandLevelSet) : _levelSet; }
+	real liquidSdfValue(const VectorDi &cell) const { return _narrowBandLevelSet ? _narrowBandLevelSet->value(cell) : _levelSet.value(cell); }
+
+	// Calls func with the narrow band if it is set, or with _levelSet otherwise.
+	template <typename Func>
+	void visitLevelSet(Func &&func) const
+	{
+		if (_narrowBandLevelSet) func(std::as_const(*_narrowBandLevelSet));
+		else func(_levelSet);
+	}
+
+	// Calls func with a dense level set, into which the narrow band is rasterized if it is set. Only for output.
+	template <typename Func>
+	void visitDenseLevelSet(Func &&func) const
+	{
+		if (!_narrowBandLevelSet) {
+			func(_levelSet);
+			return;
+		}
+		LevelSet<Dim> levelSet(_grid.cellGrid());
+		_narrowBandLevelSet->rasterize(levelSet);
+		func(std::as_const(levelSet));
+	}
 };
 
 }
@@ -40,59 +40,60 @@ void MaterialPointSubstances<Dim>::writeDescription(YAML::Node &root) const
 		node["data_mode"] = "dynamic";
 		node["primitive_type"] = "point_list";
 		node["indexed"] = false;
+		node["constant_normal"] = Vector3f::Unit(2).eval();
 		node["material"]["diffuse_albedo"] = substance->color();
 		root["objects"].push_back(node);
 	}
 }
 
 template <int Dim>
-void MaterialPointSubstances<Dim>::writeFrame(const std::string &frameDir, const bool staticDraw) const
+void MaterialPointSubstances<Dim>::writeFrame(FrameBuffer &frame, const bool staticDraw) const
 {
 	if constexpr (Dim == 2) { // Write velocity.
-		std::ofstream fout(frameDir + "/velocity.mesh", std::ios::binary);
+		auto &fout = frame.open("velocity.mesh");
 		IO::writeValue(fout, uint(2 * _grid.nodeCount()));
-		_grid.forEachNode([&](const VectorDi &node) {
+		// Each node gives a line of two vertices.
+		IO::writeMapped<VectorDf>(fout, 2 * _grid.nodeCount(), [&](const int i) {
+			const VectorDi node = _grid.nodeGrid()->coordinate(i >> 1);
 			const VectorDr pos = _grid.nodeCenter(node);
+			if (!(i & 1)) return pos.template cast<float>().eval();
 			const VectorDr dir = _velocity[node].normalized() * _grid.spacing() * std::sqrt(real(Dim)) / 2;
-			IO::writeValue(fout, pos.template cast<float>().eval());
-			IO::writeValue(fout, (pos + dir).template cast<float>().eval());
+			return (pos + dir).template cast<float>().eval();
 		});
-		_grid.forEachNode([&](const VectorDi &node) {
-			const float vel = float(_velocity[node].norm());
-			IO::writeValue(fout, vel);
-			IO::writeValue(fout, vel);
+		frame.writeHeats(fout, 2 * _grid.nodeCount(), [&](const int i) {
+			return float(_velocity[_grid.nodeGrid()->coordinate(i >> 1)].norm());
 		});
 	}
 	for (const auto &substance : _substances) {
-		std::ofstream fout(fmt::format("{}/{}.mesh", frameDir, substance->name()), std::ios::binary);
+		auto &fout = frame.open(substance->name() + ".mesh");
 		substance->write(fout);
 	}
 }
 
 template <int Dim>
-void MaterialPointSubstances<Dim>::saveFrame(const std::string &frameDir) const
+void MaterialPointSubstances<Dim>::saveFrame(FrameBuffer &frame) const
 {
 	{ // Save velocity.
-		std::ofstream fout(frameDir + "/velocity.sav", std::ios::binary);
+		auto &fout = frame.open("velocity.sav");
 		_velocity.save(fout);
 	}
 	// Save substances.
 	for (const auto &substance : _substances) {
-		std::ofstream fout(fmt::format("{}/{}.sav", frameDir, substance->name()), std::ios::binary);
+		auto &fout = frame.open(substance->name() + ".sav");
 		substance->save(fout);
 	}
 }
 
 template <int Dim>
-void MaterialPointSubstances<Dim>::loadFrame(const std::string &frameDir)
+void MaterialPointSubstances<Dim>::loadFrame(const ArchivedFrame &frame)
 {
 	{ // Load velocity.
-		std::ifstream fin(frameDir + "/velocity.sav", std::ios::binary);
+		auto fin = frame.open("velocity.sav");
 		_velocity.load(fin);
 	}
 	// Load substances.
 	for (auto &substance : _substances) {
-		std::ifstream fin(fmt::format("{}/{}.sav", frameDir, substance->name()), std::ios::binary);
+		auto fin = frame.open(substance->name() + ".sav");
 		substance->load(fin);
 	}
 }
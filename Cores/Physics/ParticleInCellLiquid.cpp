@@ -1,7 +1,11 @@
 #include "ParticleInCellLiquid.h"
 
+#include <algorithm>
 #include <numbers>
 
+#include <cmath>
+#include <cstdlib>
+
 namespace PhysX {
 
 template <int Dim>
@@ -26,48 +30,54 @@ void ParticleInCellLiquid<Dim>::writeDescription(YAML::Node &root) const
 }
 
 template <int Dim>
-void ParticleInCellLiquid<Dim>::writeFrame(const std::string &frameDir, const bool staticDraw) const
+void ParticleInCellLiquid<Dim>::writeFrame(FrameBuffer &frame, const bool staticDraw) const
 {
-	LevelSetLiquid<Dim>::writeFrame(frameDir, staticDraw);
+	LevelSetLiquid<Dim>::writeFrame(frame, staticDraw);
 	if constexpr (Dim == 2) { // Write particles.
-		std::ofstream fout(frameDir + "/particles.mesh", std::ios::binary);
+		auto &fout = frame.open("particles.mesh");
 		IO::writeValue(fout, uint(_particles.size()));
-		_particles.forEach([&](const int i) {
-			IO::writeValue(fout, _particles.positions[i].template cast<float>().eval());
-		});
+		IO::writeCast<float>(fout, _particles.positions);
 	}
 }
 
 template <int Dim>
-void ParticleInCellLiquid<Dim>::saveFrame(const std::string &frameDir) const
+void ParticleInCellLiquid<Dim>::saveFrame(FrameBuffer &frame) const
 {
-	EulerianFluid<Dim>::saveFrame(frameDir);
+	EulerianFluid<Dim>::saveFrame(frame);
 	{ // Save particles.
-		std::ofstream fout(frameDir + "/particles.sav", std::ios::binary);
+		auto &fout = frame.open("particles.sav");
 		IO::writeValue(fout, uint(_particles.size()));
 		_particles.positions.save(fout);
 	}
 }
 
 template <int Dim>
-void ParticleInCellLiquid<Dim>::loadFrame(const std::string &frameDir)
+void ParticleInCellLiquid<Dim>::loadFrame(const ArchivedFrame &frame)
 {
-	EulerianFluid<Dim>::loadFrame(frameDir);
+	EulerianFluid<Dim>::loadFrame(frame);
 	{ // Load particles.
-		std::ifstream fin(frameDir + "/particles.sav", std::ios::binary);
+		auto fin = frame.open("particles.sav");
 		uint particlesCnt;
 		IO::readValue(fin, particlesCnt);
 		_particles.resize(particlesCnt);
 		_particles.positions.load(fin);
 	}
 	reinitializeParticlesBasedData();
+	if (_narrowBandLevelSet) {
+		// Only particles are restored, so nothing but them may shape the narrow band.
+		moveLevelSetIntoNarrowBand();
+		_narrowBandLevelSet->clear();
+	}
+	reinitializeLevelSet();
 }
 
 template <int Dim>
 void ParticleInCellLiquid<Dim>::initialize()
 {
+	if (_narrowBandLevelSet) moveLevelSetIntoNarrowBand();
 	reinitializeParticles();
-	LevelSetLiquid<Dim>::initialize();
+	reinitializeLevelSet();
+	EulerianFluid<Dim>::initialize();
 }
 
 template <int Dim>
@@ -76,6 +86,10 @@ void ParticleInCellLiquid<Dim>::advance(const real dt)
 	updateColliders(dt);
 
 	transferFromGridToParticles();
+	if (_populationControlInterval && ++_stepsSincePopulationControl >= _populationControlInterval) {
+		controlParticlesPopulation(particlesBandWidth());
+		_stepsSincePopulationControl = 0;
+	}
 	advectFields(dt);
 	applyParticleForces(dt);
 	transferFromParticlesToGrid();
@@ -94,10 +108,12 @@ void ParticleInCellLiquid<Dim>::advectFields(const real dt)
 template <int Dim>
 void ParticleInCellLiquid<Dim>::transferFromGridToParticles()
 {
-	_particles.parallelForEach([&](const int i) {
-		const VectorDr &pos = _particles.positions[i];
-		_particleVelocities[i] = _velocity(pos);
-	});
+	const int cnt = int(_particles.size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int begin = 0; begin < cnt; begin += _kBatchSize)
+		_velocity.interpolate(_particles.positions.data() + begin, _particleVelocities.data() + begin, std::min(cnt - begin, _kBatchSize));
 }
 
 template <int Dim>
@@ -119,15 +135,8 @@ void ParticleInCellLiquid<Dim>::transferFromParticlesToGrid()
 template <int Dim>
 void ParticleInCellLiquid<Dim>::transferFromParticlesToGrid(StaggeredGridBasedScalarData<Dim> &weightSum)
 {
-	_particles.forEach([&](const int i) {
-		const VectorDr &pos = _particles.positions[i];
-		const VectorDr &vel = _particleVelocities[i];
-		for (int axis = 0; axis < Dim; axis++) {
-			for (const auto [face, weight] : _velocity[axis].grid()->linearIntrplDataPoints(pos)) {
-				_velocity[axis][face] += vel[axis] * weight;
-				weightSum[axis][face] += weight;
-			}
-		}
+	transferFromParticlesToFaces(weightSum, [&](const int i, const int axis, const VectorDi &) {
+		return _particleVelocities[i][axis];
 	});
 }
 
@@ -135,42 +144,81 @@ template <int Dim>
 void ParticleInCellLiquid<Dim>::maintainGridBasedData(StaggeredGridBasedScalarData<Dim> &weightSum)
 {
 	reinitializeLevelSet();
-	_boundaryHelper->extrapolate(_velocity, _levelSet, weightSum, _kExtrapMaxSteps);
+	_boundaryHelper->extrapolate(_velocity, weightSum, _kExtrapMaxSteps);
 }
 
 template <int Dim>
 void ParticleInCellLiquid<Dim>::reinitializeLevelSet()
 {
-	_levelSet.clear();
+	const Grid<Dim> *const cellGrid = _grid.cellGrid();
+	const real radius = cellGrid->spacing() * real(1.1) / real(std::numbers::sqrt2);
 
-	auto &liquidSdf = _levelSet.signedDistanceField();
-	const real radius = liquidSdf.spacing() * real(1.1) / real(std::numbers::sqrt2);
+	resetLevelSet();
 
-	_particles.forEach([&](const int i) {
-		const VectorDr &pos = _particles.positions[i];
-		const ImplicitSphere<Dim> sphere(pos, radius);
-		for (const auto &cell : liquidSdf.grid()->cubicNearbyDataPoints(pos)) {
-			if (liquidSdf.isValid(cell))
-				liquidSdf[cell] = std::min(liquidSdf[cell], sphere.signedDistance(liquidSdf.position(cell)));
+	// Each data point takes the minimum over the particles whose cubic stencils, [lower - 1, lower + 2], contain it.
+	_binner.reset(cellGrid, _particles.positions);
+	const auto splat = [&](const VectorDi &cell, real &val) {
+		for (int c = 0; c < MathFunc::pow(4, Dim); c++) {
+			VectorDi lower = cell;
+			for (int i = 0; i < Dim; i++) lower[i] += (c >> (i << 1) & 3) - 2;
+			const auto [begin, end] = _binner.bin(lower);
+			for (auto it = begin; it != end; ++it) {
+				const VectorDr &pos = _particles.positions[*it];
+				const VectorDi offset = cell - cellGrid->getLinearLower(pos);
+				if ((offset.array() < -1).any() || (offset.array() > 2).any()) continue; // clamped into the bin
+				val = std::min(val, ImplicitSphere<Dim>(pos, radius).signedDistance(cellGrid->dataPosition(cell)));
+			}
 		}
-	});
+	};
+
+	if (_narrowBandLevelSet) {
+		// Bring the tiles covered by the stencils into the band, which their corners suffice for. Tiles deep in the
+		// liquid stay out of it, since splatting cannot change their values.
+		_particles.forEach([&](const int i) {
+			const VectorDi lower = cellGrid->getLinearLower(_particles.positions[i]);
+			if (((lower.array() + 2) < 0).any() || ((lower.array() - 1) >= cellGrid->dataSize().array()).any()) return;
+			for (int c = 0; c < (1 << Dim); c++) {
+				VectorDi corner = lower;
+				for (int j = 0; j < Dim; j++) corner[j] += c >> j & 1 ? 2 : -1;
+				corner = cellGrid->clamp(corner);
+				if (_narrowBandLevelSet->value(corner) > 0)
+					_narrowBandLevelSet->activate(corner);
+			}
+		});
+		_narrowBandLevelSet->parallelForEach(splat);
+		_narrowBandLevelSet->reinitialize();
+		return;
+	}
+
+	auto &liquidSdf = _levelSet.signedDistanceField();
+	liquidSdf.parallelForEach([&](const VectorDi &cell) { splat(cell, liquidSdf[cell]); });
 
 	_levelSetReinitializer->reinitialize(_levelSet, _kLsReinitMaxSteps);
 }
 
+template <int Dim>
+void ParticleInCellLiquid<Dim>::resetLevelSet()
+{
+	if (_narrowBandLevelSet) {
+		const real bandWidth = _narrowBandLevelSet->bandWidth();
+		_narrowBandLevelSet->remap([&](const real phi) { return phi > -bandWidth ? bandWidth : phi; });
+	}
+	else _levelSet.clear();
+}
+
 template <int Dim>
 void ParticleInCellLiquid<Dim>::reinitializeParticles()
 {
 	_particles.clear();
 
-	auto &liquidSdf = _levelSet.signedDistanceField();
-	const real dx = liquidSdf.spacing();
+	const Grid<Dim> *const cellGrid = _grid.cellGrid();
+	const real dx = cellGrid->spacing();
 	const real radius = dx * real(1.1) / real(std::numbers::sqrt2);
-	liquidSdf.forEach([&](const VectorDi &cell) {
-		const VectorDr centerPos = liquidSdf.position(cell);
+	cellGrid->forEach([&](const VectorDi &cell) {
+		const VectorDr centerPos = cellGrid->dataPosition(cell);
 		for (int i = 0; i < (1 << Dim) * _particlesCntPerSubCell; i++) {
 			const VectorDr pos = centerPos + VectorDr::Random() * dx / 2;
-			if (Surface<Dim>::isInside(_levelSet.signedDistance(pos) + radius))
+			if (Surface<Dim>::isInside(liquidSurface().signedDistance(pos) + radius))
 				_particles.add(pos);
 		}
 	});
@@ -185,6 +233,112 @@ void ParticleInCellLiquid<Dim>::reinitializeParticlesBasedData()
 	_particleVelocities.setZero();
 }
 
+template <int Dim>
+void ParticleInCellLiquid<Dim>::controlParticlesPopulation(const real bandWidth)
+{
+	const Grid<Dim> *const cellGrid = _grid.cellGrid();
+	const real dx = cellGrid->spacing();
+	const real radius = dx * real(1.1) / real(std::numbers::sqrt2);
+	const real halfDiagonal = dx * std::sqrt(real(Dim)) / 2;
+	const int targetCnt = (1 << Dim) * _particlesCntPerSubCell;
+	const int minCnt = int(targetCnt * _kMinPopulationRatio);
+	const int maxCnt = int(targetCnt * _kMaxPopulationRatio);
+
+	// Count particles by the cells containing them, marking those out of the band with -1.
+	std::vector<int> cells(_particles.size());
+	_particles.parallelForEach([&](const int i) {
+		const VectorDr &pos = _particles.positions[i];
+		if (std::isfinite(bandWidth) && liquidSurface().signedDistance(pos) < -bandWidth) cells[i] = -1;
+		else cells[i] = int(cellGrid->index(cellGrid->clamp(cellGrid->getQuadraticLower(pos) + VectorDi::Ones())));
+	});
+	std::vector<int> cnts(cellGrid->dataCount(), 0);
+	for (const int cell : cells)
+		if (cell >= 0) cnts[cell]++;
+
+	// Trim crowded cells to the target by keeping a uniformly random subset of their particles, drawn in a single pass by
+	// selection sampling, and keep the others in order. The kept particles of each trimmed cell are then shifted to the
+	// means of the whole cell.
+	std::vector<int> sources;
+	std::vector<VectorDr> positions;
+	sources.reserve(_particles.size());
+	positions.reserve(_particles.size());
+	std::vector<int> keptCnts(cnts.size(), 0);
+	std::vector<int> seenCnts(cnts.size(), 0);
+	std::vector<int> groupIds(cnts.size(), -1);
+	std::vector<int> groups(_particles.size(), -1);
+	std::vector<uchar> kept(_particles.size(), false);
+	int groupsCnt = 0;
+	_particles.forEach([&](const int i) {
+		if (cells[i] < 0) return;
+		const int cell = cells[i];
+		if (cnts[cell] > maxCnt) {
+			if (groupIds[cell] < 0) groupIds[cell] = groupsCnt++;
+			groups[i] = groupIds[cell];
+			if (std::rand() % (cnts[cell] - seenCnts[cell]++) >= targetCnt - keptCnts[cell]) return;
+		}
+		keptCnts[cell]++;
+		kept[i] = true;
+		sources.push_back(i);
+		positions.push_back(_particles.positions[i]);
+	});
+	if (groupsCnt > 0) redistributeParticlesBasedData(groups, groupsCnt, kept);
+
+	// Refill starved cells to the target in the same way as the initial seeding. Only cells entirely within the seeded
+	// region are considered, since those partially out of it never reach the target and would be oversampled on every
+	// pass, and so are cells entirely within the band.
+	cellGrid->forEach([&](const VectorDi &cell) {
+		const size_t idx = cellGrid->index(cell);
+		const real phi = liquidSdfValue(cell);
+		if (cnts[idx] >= minCnt) return;
+		if (phi + halfDiagonal + radius >= 0) return;
+		if (phi - halfDiagonal <= -bandWidth) return;
+		const VectorDr centerPos = cellGrid->dataPosition(cell);
+		for (int i = cnts[idx]; i < targetCnt; i++) {
+			const VectorDr pos = centerPos + VectorDr::Random() * dx / 2;
+			if (Surface<Dim>::isInside(liquidSurface().signedDistance(pos) + radius)) {
+				sources.push_back(-1);
+				positions.push_back(pos);
+			}
+		}
+	});
+
+	_particles.resize(positions.size());
+	std::copy(positions.begin(), positions.end(), _particles.positions.data());
+	remapParticlesBasedData(sources);
+}
+
+template <int Dim>
+void ParticleInCellLiquid<Dim>::redistributeParticlesBasedData(const std::vector<int> &groups, const int groupsCnt, const std::vector<uchar> &kept)
+{
+	redistributeParticlesBasedVectorData(_particleVelocities, groups, groupsCnt, kept);
+}
+
+template <int Dim>
+void ParticleInCellLiquid<Dim>::redistributeParticlesBasedVectorData(ParticlesBasedVectorData<Dim> &data, const std::vector<int> &groups, const int groupsCnt, const std::vector<uchar> &kept)
+{
+	std::vector<VectorDr> sums(groupsCnt, VectorDr::Zero()), keptSums(groupsCnt, VectorDr::Zero());
+	std::vector<int> cnts(groupsCnt, 0), keptCnts(groupsCnt, 0);
+	_particles.forEach([&](const int i) {
+		if (groups[i] < 0) return;
+		sums[groups[i]] += data[i], cnts[groups[i]]++;
+		if (kept[i]) keptSums[groups[i]] += data[i], keptCnts[groups[i]]++;
+	});
+	_particles.parallelForEach([&](const int i) {
+		if (groups[i] < 0 || !kept[i]) return;
+		data[i] += sums[groups[i]] / cnts[groups[i]] - keptSums[groups[i]] / keptCnts[groups[i]];
+	});
+}
+
+template <int Dim>
+void ParticleInCellLiquid<Dim>::remapParticlesBasedData(const std::vector<int> &sources)
+{
+	ParticlesBasedVectorData<Dim> velocities(&_particles);
+	_particles.parallelForEach([&](const int i) {
+		velocities[i] = sources[i] < 0 ? _velocity(_particles.positions[i]) : _particleVelocities[sources[i]];
+	});
+	_particleVelocities = std::move(velocities);
+}
+
 template class ParticleInCellLiquid<2>;
 template class ParticleInCellLiquid<3>;
 
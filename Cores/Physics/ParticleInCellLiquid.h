@@ -2,6 +2,12 @@
 
 #include "Physics/LevelSetLiquid.h"
 #include "Structures/ParticlesBasedData.h"
+#include "Structures/ParticlesGridBinner.h"
+
+#include <array>
+#include <limits>
+#include <tuple>
+#include <vector>
 
 namespace PhysX {
 
@@ -16,6 +22,11 @@ public:
 
 protected:
 
+	static constexpr int _kBatchSize = 64;
+	// Bounds of particles per cell, relative to the initial seeding, out of which the population is controlled.
+	static constexpr real _kMinPopulationRatio = real(.5);
+	static constexpr real _kMaxPopulationRatio = real(2);
+
 	using EulerianFluid<Dim>::_kExtrapMaxSteps;
 	using EulerianFluid<Dim>::_grid;
 	using EulerianFluid<Dim>::_velocity;
@@ -24,11 +35,17 @@ protected:
 	using LevelSetLiquid<Dim>::_kLsReinitMaxSteps;
 	using LevelSetLiquid<Dim>::_levelSet;
 	using LevelSetLiquid<Dim>::_levelSetReinitializer;
+	using LevelSetLiquid<Dim>::_narrowBandLevelSet;
 
 	const int _particlesCntPerSubCell;
 	Particles<Dim> _particles;
 	ParticlesBasedVectorData<Dim> _particleVelocities;
 
+	ParticlesGridBinner<Dim> _binner;
+
+	int _populationControlInterval = 0; // in steps, or 0 to disable
+	int _stepsSincePopulationControl = 0;
+
 public:
 
 	ParticleInCellLiquid(const StaggeredGrid<Dim> &grid, const int particlesCntPerSubcell);
@@ -38,9 +55,9 @@ public:
 	virtual ~ParticleInCellLiquid() = default;
 
 	virtual void writeDescription(YAML::Node &root) const override;
-	virtual void writeFrame(const std::string &frameDir, const bool staticDraw) const override;
-	virtual void saveFrame(const std::string &frameDir) const override;
-	virtual void loadFrame(const std::string &frameDir) override;
+	virtual void writeFrame(FrameBuffer &frame, const bool staticDraw) const override;
+	virtual void saveFrame(FrameBuffer &frame) const override;
+	virtual void loadFrame(const ArchivedFrame &frame) override;
 
 	virtual void initialize() override;
 	virtual void advance(const real dt) override;
@@ -50,6 +67,10 @@ protected:
 	using EulerianFluid<Dim>::updateColliders;
 	using LevelSetLiquid<Dim>::applyBodyForces;
 	using LevelSetLiquid<Dim>::projectVelocity;
+	using LevelSetLiquid<Dim>::moveLevelSetIntoNarrowBand;
+	using LevelSetLiquid<Dim>::liquidSurface;
+	using LevelSetLiquid<Dim>::liquidSdfValue;
+	using LevelSetLiquid<Dim>::visitLevelSet;
 
 	virtual void advectFields(const real dt) override;
 	virtual void applyParticleForces(const real dt) { }
@@ -59,8 +80,63 @@ protected:
 	virtual void transferFromParticlesToGrid(StaggeredGridBasedScalarData<Dim> &weightSum);
 	virtual void maintainGridBasedData(StaggeredGridBasedScalarData<Dim> &weightSum);
 	virtual void reinitializeLevelSet() override;
+	// Prepares the level set for particles to be splatted into. Values within the narrow band are discarded, while
+	// tiles deep in the liquid are kept, so that only those around the surface are brought into the band.
+	virtual void resetLevelSet();
 	virtual void reinitializeParticles();
 	virtual void reinitializeParticlesBasedData();
+
+	// Depth beneath the surface within which the liquid is represented by particles.
+	virtual real particlesBandWidth() const { return std::numeric_limits<real>::infinity(); }
+	// Particles deeper than bandWidth in the liquid are deleted, and cells deeper than it are not refilled.
+	void controlParticlesPopulation(const real bandWidth);
+	// Shifts the data of the particles kept in each trimmed cell, given by groups[i] >= 0, so that the means over the cell
+	// and thus its momentum per unit mass are preserved when the others are removed.
+	virtual void redistributeParticlesBasedData(const std::vector<int> &groups, const int groupsCnt, const std::vector<uchar> &kept);
+	void redistributeParticlesBasedVectorData(ParticlesBasedVectorData<Dim> &data, const std::vector<int> &groups, const int groupsCnt, const std::vector<uchar> &kept);
+	// Rearranges particles based data after the population is controlled, where sources[i] is the former index of
+	// particle i, or -1 if it is newly seeded and takes its data from the grid.
+	virtual void remapParticlesBasedData(const std::vector<int> &sources);
+
+	// Splats func(i, axis, face) of particles into faces with linear weights. Faces gather from the particles binned
+	// around them in increasing order of indices, so the sums are exactly those of a serial loop over particles, in
+	// parallel and regardless of the number of threads.
+	template <typename Func>
+	void transferFromParticlesToFaces(StaggeredGridBasedScalarData<Dim> &weightSum, Func &&func)
+	{
+		constexpr int kCntCorners = 1 << Dim;
+		for (int axis = 0; axis < Dim; axis++) {
+			const Grid<Dim> *const faceGrid = _velocity[axis].grid();
+			_binner.reset(faceGrid, _particles.positions);
+			_velocity[axis].parallelForEach([&](const VectorDi &face) {
+				std::array<const int *, kCntCorners> heads, ends;
+				for (int c = 0; c < kCntCorners; c++) {
+					VectorDi lower = face;
+					for (int i = 0; i < Dim; i++) lower[i] -= c >> i & 1;
+					std::tie(heads[c], ends[c]) = _binner.bin(lower);
+				}
+				real val = 0, weightSumVal = 0;
+				while (true) {
+					int next = -1;
+					for (int c = 0; c < kCntCorners; c++)
+						if (heads[c] != ends[c] && (next < 0 || *heads[c] < *heads[next])) next = c;
+					if (next < 0) break;
+					const int i = *heads[next]++;
+					const VectorDr &pos = _particles.positions[i];
+					const VectorDi lower = faceGrid->getLinearLower(pos);
+					const VectorDi offset = face - lower;
+					if ((offset.array() < 0).any() || (offset.array() > 1).any()) continue; // clamped into the bin
+					const VectorDr frac = faceGrid->getLowerFrac(pos, lower);
+					real weight = offset[0] ? frac[0] : 1 - frac[0];
+					for (int j = 1; j < Dim; j++) weight *= offset[j] ? frac[j] : 1 - frac[j];
+					val += func(i, axis, face) * weight;
+					weightSumVal += weight;
+				}
+				_velocity[axis][face] = val;
+				weightSum[axis][face] = weightSumVal;
+			});
+		}
+	}
 };
 
 }
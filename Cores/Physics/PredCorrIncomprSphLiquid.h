@@ -9,15 +9,14 @@ namespace PhysX {
 
     protected:
         using SmthParticleHydrodLiquid<Dim>::_particles;
+        using SmthParticleHydrodLiquid<Dim>::_velocities;
+        using SmthParticleHydrodLiquid<Dim>::_pressures;
         using SmthParticleHydrodLiquid<Dim>::_colliders;
         using SmthParticleHydrodLiquid<Dim>::_targetDensity;
 
         static constexpr int  _kPredCorrMaxIters   = 5;
         static constexpr real _kPredCorrErrorRatio = real(.01);
 
-        ParticlesBasedVectorField<Dim> _velocities;
-        ParticlesBasedScalarField<Dim> _pressures;
-
         ParticlesBasedVectorData<Dim>  _predPositions;
         ParticlesBasedVectorField<Dim> _predVelocities;
         ParticlesBasedScalarData<Dim>  _densityErrors;
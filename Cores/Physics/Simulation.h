@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Physics/FrameBuffer.h"
 #include "Utilities/Types.h"
 #include "Utilities/Yaml.h"
 
@@ -26,9 +27,9 @@ public:
 
 	virtual int dimension() const = 0;
 	virtual void writeDescription(YAML::Node &root) const = 0;
-	virtual void writeFrame(const std::string &frameDir, const bool staticDraw) const = 0;
-	virtual void saveFrame(const std::string &frameDir) const = 0;
-	virtual void loadFrame(const std::string &frameDir) = 0;
+	virtual void writeFrame(FrameBuffer &frame, const bool staticDraw) const = 0;
+	virtual void saveFrame(FrameBuffer &frame) const = 0;
+	virtual void loadFrame(const ArchivedFrame &frame) = 0;
 
 	virtual void initialize() { }
 	virtual void advance(const real dt) = 0;
@@ -1,5 +1,6 @@
 #include "Simulator.h"
 
+#include "Structures/ScratchPool.h"
 #include "Utilities/Yaml.h"
 
 #include <fmt/core.h>
@@ -28,7 +29,8 @@ void Simulator::Simulate()
 		}
 
 		createOutputDirectory();
-		writeAndSaveToFrameDirectory(0, true);
+		_frameWriter = std::make_unique<FrameWriter>(_outputDir, false);
+		writeAndSaveToFrameArchive(0, true);
 
 		{ // Write description.
 			YAML::Node root;
@@ -41,7 +43,8 @@ void Simulator::Simulate()
 		_beginFrame = 1;
 	}
 	else {
-		loadFromFrameDirectory(_beginFrame - 1);
+		loadFromFrameArchive(_beginFrame - 1);
+		_frameWriter = std::make_unique<FrameWriter>(_outputDir, true);
 	}
 
 	// Initialize timing.
@@ -55,19 +58,24 @@ void Simulator::Simulate()
 		_simulation->setTime(real(frame - 1) / _frameRate);
 		advanceTimeBySteps(real(1) / _frameRate);
 		// Write and save files for frame.
-		writeAndSaveToFrameDirectory(frame);
-		// Output timing.
+		writeAndSaveToFrameArchive(frame);
+		// Output timing, and the scratch buffers allocated so far, which stop growing once steps reach a steady state.
 		const auto currentTime = steady_clock::now();
 		std::cout << fmt::format(
 			"#  Time: {:>9.2f}s / {:>9.2f}s\n"
-			"   Prediction:        {:>9.2f}s\n",
+			"   Prediction:        {:>9.2f}s\n"
+			"   Scratch buffers:   {:>9}\n",
 			duration<double>(currentTime - lastTime).count(),
 			duration<double>(currentTime - initialTime).count(),
 			duration<double>(currentTime - beginTime).count() / (frame - _beginFrame + 1.0) * (_endFrame - _beginFrame)
-				+ duration<double>(beginTime - initialTime).count()
+				+ duration<double>(beginTime - initialTime).count(),
+			ScratchPoolBase::allocationCount()
 			) << std::endl;
 		lastTime = currentTime;
 	}
+
+	// Wait for pending frames to be written.
+	_frameWriter->finish();
 }
 
 void Simulator::createOutputDirectory() const
@@ -76,28 +84,27 @@ void Simulator::createOutputDirectory() const
 	std::filesystem::create_directories(_outputDir);
 }
 
-void Simulator::writeAndSaveToFrameDirectory(const uint frame, const bool staticDraw) const
+void Simulator::writeAndSaveToFrameArchive(const uint frame, const bool staticDraw)
 {
-	// Create, write and save to the frame directory.
+	// Write and save to a frame buffer, which is appended to the frame archive in the background.
 	std::cout << fmt::format("** Write output files for frame {}...", frame) << std::endl;
-	const std::string frameDir = fmt::format("{}/{}", _outputDir, frame);
-	std::filesystem::create_directory(frameDir);
-	_simulation->writeFrame(frameDir, staticDraw);
-	_simulation->saveFrame(frameDir);
-	// Write the last frame.
-	std::ofstream fout(_outputDir + "/end_frame.txt");
-	fout << frame + 1 << std::endl;
+	auto &buffer = _frameWriter->acquire();
+	_simulation->writeFrame(buffer, staticDraw);
+	_simulation->saveFrame(buffer);
+	_frameWriter->submit(frame);
 }
 
-void Simulator::loadFromFrameDirectory(const uint frame)
+void Simulator::loadFromFrameArchive(const uint frame)
 {
 	std::cout << fmt::format("** Load output files for frame {}...", frame) << std::endl;
-	const std::string frameDir = fmt::format("{}/{}", _outputDir, frame);
-	if (!std::filesystem::exists(frameDir)) {
-		std::cerr << fmt::format("Error: [Simulator] No output directory for frame {}.", frame) << std::endl;
+	// The archive is unmapped before it is reopened for appending.
+	FrameArchive archive;
+	if (!archive.open(_outputDir + "/" + FrameArchive::kFileName) || !archive.contains(frame)) {
+		std::cerr << fmt::format("Error: [Simulator] No archived output for frame {}.", frame) << std::endl;
 		std::exit(1);
 	}
-	_simulation->loadFrame(frameDir);
+	_simulation->setTime(real(frame) / _frameRate);
+	_simulation->loadFrame(archive.frame(frame));
 }
 
 void Simulator::advanceTimeBySteps(const real targetTime)
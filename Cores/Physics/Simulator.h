@@ -1,8 +1,10 @@
 #pragma once
 
+#include "Physics/FrameWriter.h"
 #include "Physics/Simulation.h"
 #include "Utilities/Types.h"
 
+#include <memory>
 #include <string>
 
 namespace PhysX {
@@ -19,6 +21,8 @@ protected:
 
 	Simulation *const _simulation;
 
+	std::unique_ptr<FrameWriter> _frameWriter;
+
 public:
 
 	Simulator(
@@ -46,8 +50,8 @@ public:
 protected:
 
 	void createOutputDirectory() const;
-	void writeAndSaveToFrameDirectory(const uint frame, const bool staticDraw = false) const;
-	void loadFromFrameDirectory(const uint frame);
+	void writeAndSaveToFrameArchive(const uint frame, const bool staticDraw = false);
+	void loadFromFrameArchive(const uint frame);
 	void advanceTimeBySteps(const real targetTime);
 };
 
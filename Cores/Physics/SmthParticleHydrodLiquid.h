@@ -42,9 +42,9 @@ namespace PhysX {
 
         virtual int  dimension() const override { return Dim; }
         virtual void writeDescription(YAML::Node & root) const override;
-        virtual void writeFrame(const std::string & frameDir, const bool staticDraw) const override;
-        virtual void saveFrame(const std::string & frameDir) const override;
-        virtual void loadFrame(const std::string & frameDir) override;
+        virtual void writeFrame(FrameBuffer & frame, const bool staticDraw) const override;
+        virtual void saveFrame(FrameBuffer & frame) const override;
+        virtual void loadFrame(const ArchivedFrame & frame) override;
 
         virtual void initialize() override;
         virtual void advance(const real dt) override;
@@ -9,34 +9,99 @@ void SpringMassSysIntegrator<Dim>::accumulateForces(
 	const ParticlesVectorAttribute<Dim> &positions,
 	const ParticlesVectorAttribute<Dim> &velocities,
 	ParticlesVectorAttribute<Dim> &forces,
-	const std::unordered_set<int> &constrainedDofs) const
+	const DofMask &constrainedDofs) const
 {
 	forces.setZero();
 
-	for (const auto &spring : *_springs) {
-		const int pid0 = spring.pid0;
-		const int pid1 = spring.pid1;
-		const VectorDr r01 = positions[pid1] - positions[pid0];
-		const VectorDr v01 = velocities[pid1] - velocities[pid0];
-		const real length = r01.norm();
-		const VectorDr e01 = r01.normalized();
-		const VectorDr force = e01 * ((length - spring.restLength) * spring.stiffnessCoeff + e01.dot(v01) * spring.dampingCoeff);
-		forces[pid0] += force;
-		forces[pid1] -= force;
+	// Springs of the same color share no particle, so each color is accumulated in parallel without races.
+	const int colorCnt = int(_colorOffsets.size()) - 1;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	for (int color = 0; color < colorCnt; color++) {
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (int k = _colorOffsets[color]; k < _colorOffsets[color + 1]; k++) {
+			const auto &spring = (*_springs)[_coloredSprings[k]];
+			const int pid0 = spring.pid0;
+			const int pid1 = spring.pid1;
+			const VectorDr r01 = positions[pid1] - positions[pid0];
+			const VectorDr v01 = velocities[pid1] - velocities[pid0];
+			const real length = r01.norm();
+			const VectorDr e01 = r01.normalized();
+			const VectorDr force = e01 * ((length - spring.restLength) * spring.stiffnessCoeff + e01.dot(v01) * spring.dampingCoeff);
+			forces[pid0] += force;
+			forces[pid1] -= force;
+		}
 	}
 
 	// Constrain degrees of freedom.
-	for (const int dof : constrainedDofs) {
-		*(reinterpret_cast<real *>(forces.data()) + dof) = 0;
+	if (constrainedDofs.empty()) return;
+	real *const data = reinterpret_cast<real *>(forces.data());
+	const int dofCnt = int(forces.size() * Dim);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int dof = 0; dof < dofCnt; dof++) {
+		if (constrainedDofs.contains(dof)) data[dof] = 0;
+	}
+}
+
+template <int Dim>
+void SpringMassSysIntegrator<Dim>::resetIncidentSprings()
+{
+	_incidentSpringOffsets.assign(_particles->size() + 1, 0);
+	for (const auto &spring : *_springs) {
+		_incidentSpringOffsets[spring.pid0 + 1]++;
+		_incidentSpringOffsets[spring.pid1 + 1]++;
+	}
+	for (size_t pid = 0; pid < _particles->size(); pid++)
+		_incidentSpringOffsets[pid + 1] += _incidentSpringOffsets[pid];
+	_incidentSprings.resize(_incidentSpringOffsets.back());
+	std::vector<int> counters(_incidentSpringOffsets.begin(), _incidentSpringOffsets.end() - 1);
+	for (int sid = 0; sid < int(_springs->size()); sid++) {
+		_incidentSprings[counters[(*_springs)[sid].pid0]++] = sid;
+		_incidentSprings[counters[(*_springs)[sid].pid1]++] = sid;
 	}
 }
 
+template <int Dim>
+void SpringMassSysIntegrator<Dim>::resetSpringColors()
+{
+	// Greedy edge coloring, which takes at most 2 * maxDegree - 1 colors. A color is taken by the current spring if it
+	// is stamped with the spring's index.
+	const int springCnt = int(_springs->size());
+	std::vector<int> colors(springCnt, -1);
+	std::vector<int> stamps;
+	for (int sid = 0; sid < springCnt; sid++) {
+		for (const int pid : { (*_springs)[sid].pid0, (*_springs)[sid].pid1 }) {
+			for (int k = _incidentSpringOffsets[pid]; k < _incidentSpringOffsets[pid + 1]; k++) {
+				const int color = colors[_incidentSprings[k]];
+				if (color >= 0) stamps[color] = sid;
+			}
+		}
+		int color = 0;
+		while (color < int(stamps.size()) && stamps[color] == sid) color++;
+		if (color == int(stamps.size())) stamps.push_back(-1);
+		colors[sid] = color;
+	}
+
+	// Counting sort, which keeps springs of each color in increasing order of indices.
+	_colorOffsets.assign(stamps.size() + 1, 0);
+	for (int sid = 0; sid < springCnt; sid++) _colorOffsets[colors[sid] + 1]++;
+	for (size_t color = 0; color < stamps.size(); color++) _colorOffsets[color + 1] += _colorOffsets[color];
+	_coloredSprings.resize(springCnt);
+	std::vector<int> counters(_colorOffsets.begin(), _colorOffsets.end() - 1);
+	for (int sid = 0; sid < springCnt; sid++) _coloredSprings[counters[colors[sid]]++] = sid;
+}
+
 template <int Dim>
 void SmsSymplecticEulerIntegrator<Dim>::integrate(
 	const ParticlesVectorAttribute<Dim> &positions,
 	ParticlesVectorAttribute<Dim> &velocities,
 	const real dt,
-	const std::unordered_set<int> &constrainedDofs)
+	const DofMask &constrainedDofs)
 {
 	accumulateForces(positions, velocities, _forces, constrainedDofs);
 	velocities.asVectorXr() += _forces.asVectorXr() * _particles->invMass() * dt;
@@ -47,63 +112,171 @@ void SmsSemiImplicitIntegrator<Dim>::integrate(
 	const ParticlesVectorAttribute<Dim> &positions,
 	ParticlesVectorAttribute<Dim> &velocities,
 	const real dt,
-	const std::unordered_set<int> &constrainedDofs)
+	const DofMask &constrainedDofs)
 {
-	_coefficients.clear();
+	accumulateForces(positions, velocities, _forces, constrainedDofs);
 
-	const auto addSparseBlockValue = [&](const int pid0, const int pid1, const MatrixDr &block) {
-		const int offset0 = pid0 * Dim;
-		const int offset1 = pid1 * Dim;
-		for (int i = 0; i < Dim; i++) {
-			if (constrainedDofs.contains(offset0 + i)) continue;
-			for (int j = 0; j < Dim; j++) {
-				if (constrainedDofs.contains(offset1 + j)) continue;
-				_coefficients.push_back(Tripletr(offset0 + i, offset1 + j, block(i, j)));
+	// Compute Jacobians of force to velocity and to position for every spring.
+	_dampingBlocks.resize(_springs->size());
+	_stiffnessBlocks.resize(_springs->size());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int sid = 0; sid < int(_springs->size()); sid++) {
+		const auto &spring = (*_springs)[sid];
+		const VectorDr r01 = positions[spring.pid1] - positions[spring.pid0];
+		const real length = r01.norm();
+		const VectorDr e01 = r01.normalized();
+		_dampingBlocks[sid] = spring.dampingCoeff * e01 * e01.transpose() * dt;
+		_stiffnessBlocks[sid] = spring.stiffnessCoeff * ((spring.restLength / length - 1) * MatrixDr::Identity() - spring.restLength / length * e01 * e01.transpose()) * dt * dt;
+	}
+
+	// Assemble row by row, accumulating the right-hand side with the velocity Jacobian only.
+	const auto vel = velocities.asVectorXr();
+	const auto force = _forces.asVectorXr();
+	const int cnt = int(_particles->size() * Dim);
+	_linearizedAssembler.assemble(cnt, cnt, [&](const int row, SparseAssembler::RowBuilder &builder) {
+		const int pid = row / Dim;
+		const int i = row % Dim;
+		real rhs = _particles->mass() * vel[row] + force[row] * dt;
+		builder.add(row, _particles->mass());
+		if (!constrainedDofs.contains(row)) {
+			const auto addBlockRow = [&](const int offset, const int sid, const real sign) {
+				for (int j = 0; j < Dim; j++) {
+					if (constrainedDofs.contains(offset + j)) continue;
+					const real dampingValue = sign * _dampingBlocks[sid](i, j);
+					builder.add(offset + j, dampingValue + sign * _stiffnessBlocks[sid](i, j));
+					rhs += dampingValue * vel[offset + j];
+				}
+			};
+			for (int k = _incidentSpringOffsets[pid]; k < _incidentSpringOffsets[pid + 1]; k++) {
+				const int sid = _incidentSprings[k];
+				const auto &spring = (*_springs)[sid];
+				addBlockRow(pid * Dim, sid, -1);
+				addBlockRow((spring.pid0 == pid ? spring.pid1 : spring.pid0) * Dim, sid, 1);
 			}
 		}
-	};
-
-	// Set diagonal blocks.
-	_particles->forEach([&](const int pid) {
-		const int offset = pid * Dim;
-		for (int i = 0; i < Dim; i++)
-			_coefficients.push_back(Tripletr(offset + i, offset + i, _particles->mass()));
+		_rhsLinearized[row] = rhs;
 	});
 
-	// Set Jacobian of force to velocity.
+	IterativeSolver::solve(_linearizedAssembler.matrix(), velocities.asVectorXr(), _rhsLinearized);
+}
+
+template <int Dim>
+void SmsProjectiveDynamicsIntegrator<Dim>::integrate(
+	const ParticlesVectorAttribute<Dim> &positions,
+	ParticlesVectorAttribute<Dim> &velocities,
+	const real dt,
+	const DofMask &constrainedDofs)
+{
+	if (dt != _factorizedDt || !(constrainedDofs == _factorizedDofs))
+		factorize(dt, constrainedDofs);
+
+	predictInertialPositions(positions, velocities, dt, constrainedDofs);
+	_newPositions.asVectorXr() = _inertialPositions.asVectorXr();
+	for (int iter = 0; iter < _kIters; iter++) {
+		projectSprings();
+		solveGlobal(dt, constrainedDofs);
+	}
+
+	velocities.asVectorXr() = (_newPositions.asVectorXr() - positions.asVectorXr()) / dt;
+}
+
+template <int Dim>
+void SmsProjectiveDynamicsIntegrator<Dim>::factorize(const real dt, const DofMask &constrainedDofs)
+{
+	// The global matrix M / dt^2 + L, where L is the Laplacian of springs weighted by stiffnesses, is the same for
+	// every axis. Constrained degrees of freedom are eliminated symmetrically, which keeps the matrix positive definite.
+	const int cnt = int(_particles->size() * Dim);
+	const real inertia = _particles->mass() / (dt * dt);
+	std::vector<Tripletr> elements;
+	for (int row = 0; row < cnt; row++)
+		elements.push_back(Tripletr(row, row, constrainedDofs.contains(row) ? 1 : inertia));
 	for (const auto &spring : *_springs) {
-		const int pid0 = spring.pid0;
-		const int pid1 = spring.pid1;
-		const VectorDr r01 = positions[pid1] - positions[pid0];
-		const VectorDr e01 = r01.normalized();
-		const MatrixDr block = spring.dampingCoeff * e01 * e01.transpose() * dt;
-		addSparseBlockValue(pid0, pid0, -block);
-		addSparseBlockValue(pid0, pid1, block);
-		addSparseBlockValue(pid1, pid0, block);
-		addSparseBlockValue(pid1, pid1, -block);
+		for (int i = 0; i < Dim; i++) {
+			const int dof0 = spring.pid0 * Dim + i;
+			const int dof1 = spring.pid1 * Dim + i;
+			const bool free0 = !constrainedDofs.contains(dof0);
+			const bool free1 = !constrainedDofs.contains(dof1);
+			if (free0) elements.push_back(Tripletr(dof0, dof0, spring.stiffnessCoeff));
+			if (free1) elements.push_back(Tripletr(dof1, dof1, spring.stiffnessCoeff));
+			if (free0 && free1) {
+				elements.push_back(Tripletr(dof0, dof1, -spring.stiffnessCoeff));
+				elements.push_back(Tripletr(dof1, dof0, -spring.stiffnessCoeff));
+			}
+		}
 	}
+	_matGlobal.resize(cnt, cnt);
+	_matGlobal.setFromTriplets(elements.begin(), elements.end());
 
-	_matLinearized.setFromTriplets(_coefficients.begin(), _coefficients.end());
+	_globalSolver.compute(_matGlobal);
+	if (_globalSolver.info() != Eigen::Success) {
+		std::cerr << "Error: [SmsProjectiveDynamicsIntegrator] failed to factorize matrix." << std::endl;
+		std::exit(-1);
+	}
+	_factorizedDt = dt;
+	_factorizedDofs = constrainedDofs;
+}
 
-	accumulateForces(positions, velocities, _forces, constrainedDofs);
-	_rhsLinearized = _matLinearized * velocities.asVectorXr() + _forces.asVectorXr() * dt;
+template <int Dim>
+void SmsProjectiveDynamicsIntegrator<Dim>::predictInertialPositions(
+	const ParticlesVectorAttribute<Dim> &positions,
+	const ParticlesVectorAttribute<Dim> &velocities,
+	const real dt,
+	const DofMask &constrainedDofs)
+{
+	// Damping is not a potential, so it is applied explicitly along springs at the beginning of the step.
+	_particles->parallelForEach([&](const int pid) {
+		VectorDr force = VectorDr::Zero();
+		for (int k = _incidentSpringOffsets[pid]; k < _incidentSpringOffsets[pid + 1]; k++) {
+			const auto &spring = (*_springs)[_incidentSprings[k]];
+			const VectorDr e01 = (positions[spring.pid1] - positions[spring.pid0]).normalized();
+			const VectorDr f01 = e01 * e01.dot(velocities[spring.pid1] - velocities[spring.pid0]) * spring.dampingCoeff;
+			force += spring.pid0 == pid ? f01 : -f01;
+		}
+		for (int i = 0; i < Dim; i++) {
+			if (constrainedDofs.contains(pid * Dim + i)) force[i] = 0;
+		}
+		_inertialPositions[pid] = positions[pid] + (velocities[pid] + force * _particles->invMass() * dt) * dt;
+	});
+}
 
-	// Set Jacobian of force to position.
-	for (const auto &spring : *_springs) {
-		const int pid0 = spring.pid0;
-		const int pid1 = spring.pid1;
-		const VectorDr r01 = positions[pid1] - positions[pid0];
-		const double length = r01.norm();
-		const VectorDr e01 = r01.normalized();
-		const MatrixDr block = spring.stiffnessCoeff * ((spring.restLength / length - 1) * MatrixDr::Identity() - spring.restLength / length * e01 * e01.transpose()) * dt * dt;
-		addSparseBlockValue(pid0, pid0, -block);
-		addSparseBlockValue(pid0, pid1, block);
-		addSparseBlockValue(pid1, pid0, block);
-		addSparseBlockValue(pid1, pid1, -block);
+template <int Dim>
+void SmsProjectiveDynamicsIntegrator<Dim>::projectSprings()
+{
+	// The local step projects every spring onto its rest length, keeping its direction.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int sid = 0; sid < int(_springs->size()); sid++) {
+		const auto &spring = (*_springs)[sid];
+		_projections[sid] = (_newPositions[spring.pid1] - _newPositions[spring.pid0]).normalized() * spring.restLength;
 	}
+}
+
+template <int Dim>
+void SmsProjectiveDynamicsIntegrator<Dim>::solveGlobal(const real dt, const DofMask &constrainedDofs)
+{
+	const real inertia = _particles->mass() / (dt * dt);
+	_particles->parallelForEach([&](const int pid) {
+		VectorDr rhs = _inertialPositions[pid] * inertia;
+		for (int k = _incidentSpringOffsets[pid]; k < _incidentSpringOffsets[pid + 1]; k++) {
+			const int sid = _incidentSprings[k];
+			const auto &spring = (*_springs)[sid];
+			const int other = spring.pid0 == pid ? spring.pid1 : spring.pid0;
+			rhs += spring.stiffnessCoeff * (spring.pid0 == pid ? -_projections[sid] : _projections[sid]);
+			// Eliminated couplings to constrained degrees of freedom.
+			for (int i = 0; i < Dim; i++) {
+				if (constrainedDofs.contains(other * Dim + i)) rhs[i] += spring.stiffnessCoeff * _inertialPositions[other][i];
+			}
+		}
+		for (int i = 0; i < Dim; i++) {
+			const int row = pid * Dim + i;
+			_rhsGlobal[row] = constrainedDofs.contains(row) ? _inertialPositions[pid][i] : rhs[i];
+		}
+	});
 
-	_matLinearized.setFromTriplets(_coefficients.begin(), _coefficients.end());
-	IterativeSolver::solve(_matLinearized, velocities.asVectorXr(), _rhsLinearized);
+	_newPositions.asVectorXr() = _globalSolver.solve(_rhsGlobal);
 }
 
 template class SpringMassSysIntegrator<2>;
@@ -112,5 +285,7 @@ template class SmsSymplecticEulerIntegrator<2>;
 template class SmsSymplecticEulerIntegrator<3>;
 template class SmsSemiImplicitIntegrator<2>;
 template class SmsSemiImplicitIntegrator<3>;
+template class SmsProjectiveDynamicsIntegrator<2>;
+template class SmsProjectiveDynamicsIntegrator<3>;
 
 }
@@ -1,12 +1,40 @@
 #pragma once
 
 #include "Materials/Spring.h"
+#include "Solvers/SparseAssembler.h"
 #include "Structures/ParticlesBasedData.h"
 
-#include <unordered_set>
+#include <cstdint>
 
 namespace PhysX {
 
+// A dense bitmask over degrees of freedom, which grows on insertion.
+class DofMask
+{
+protected:
+
+	std::vector<std::uint64_t> _words;
+
+public:
+
+	void insert(const int dof)
+	{
+		const size_t word = size_t(dof) >> 6;
+		if (word >= _words.size()) _words.resize(word + 1, 0);
+		_words[word] |= std::uint64_t(1) << (dof & 63);
+	}
+
+	bool contains(const int dof) const
+	{
+		const size_t word = size_t(dof) >> 6;
+		return word < _words.size() && (_words[word] >> (dof & 63) & 1);
+	}
+
+	bool empty() const { return _words.empty(); }
+
+	bool operator==(const DofMask &rhs) const = default;
+};
+
 template <int Dim>
 class SpringMassSysIntegrator
 {
@@ -17,6 +45,14 @@ protected:
 	const Particles<Dim> *_particles = nullptr;
 	const std::vector<Spring> *_springs = nullptr;
 
+	// Springs incident to particle i are _incidentSprings[_incidentSpringOffsets[i], _incidentSpringOffsets[i + 1]).
+	std::vector<int> _incidentSpringOffsets;
+	std::vector<int> _incidentSprings;
+
+	// Springs of color c are _coloredSprings[_colorOffsets[c], _colorOffsets[c + 1]), no two of which share a particle.
+	std::vector<int> _colorOffsets;
+	std::vector<int> _coloredSprings;
+
 public:
 
 	SpringMassSysIntegrator() = default;
@@ -28,13 +64,15 @@ public:
 	{
 		_particles = particles;
 		_springs = springs;
+		resetIncidentSprings();
+		resetSpringColors();
 	}
 
 	virtual void integrate(
 		const ParticlesVectorAttribute<Dim> &positions,
 		ParticlesVectorAttribute<Dim> &velocities,
 		const real dt,
-		const std::unordered_set<int> &constrainedDofs) = 0;
+		const DofMask &constrainedDofs) = 0;
 
 protected:
 
@@ -42,7 +80,10 @@ protected:
 		const ParticlesVectorAttribute<Dim> &positions,
 		const ParticlesVectorAttribute<Dim> &velocities,
 		ParticlesVectorAttribute<Dim> &forces,
-		const std::unordered_set<int> &constrainedDofs) const;
+		const DofMask &constrainedDofs) const;
+
+	void resetIncidentSprings();
+	void resetSpringColors();
 };
 
 template <int Dim>
@@ -74,7 +115,7 @@ public:
 		const ParticlesVectorAttribute<Dim> &positions,
 		ParticlesVectorAttribute<Dim> &velocities,
 		const real dt,
-		const std::unordered_set<int> &constrainedDofs) override;
+		const DofMask &constrainedDofs) override;
 
 protected:
 
@@ -90,11 +131,15 @@ protected:
 
 	using SpringMassSysIntegrator<Dim>::_particles;
 	using SpringMassSysIntegrator<Dim>::_springs;
+	using SpringMassSysIntegrator<Dim>::_incidentSpringOffsets;
+	using SpringMassSysIntegrator<Dim>::_incidentSprings;
 
 	ParticlesBasedVectorData<Dim> _forces;
 
-	std::vector<Tripletr> _coefficients;
-	SparseMatrixr _matLinearized;
+	std::vector<MatrixDr> _dampingBlocks;
+	std::vector<MatrixDr> _stiffnessBlocks;
+
+	SparseAssembler _linearizedAssembler;
 	VectorXr _rhsLinearized;
 
 public:
@@ -108,19 +153,78 @@ public:
 	{
 		SpringMassSysIntegrator<Dim>::reset(particles, springs);
 		_forces.resize(particles);
-		_matLinearized.resize(particles->size() * Dim, particles->size() * Dim);
 		_rhsLinearized.resize(particles->size() * Dim);
+		_linearizedAssembler.invalidate();
 	}
 
 	virtual void integrate(
 		const ParticlesVectorAttribute<Dim> &positions,
 		ParticlesVectorAttribute<Dim> &velocities,
 		const real dt,
-		const std::unordered_set<int> &constrainedDofs) override;
+		const DofMask &constrainedDofs) override;
 
 protected:
 
 	using SpringMassSysIntegrator<Dim>::accumulateForces;
 };
 
+template <int Dim>
+class SmsProjectiveDynamicsIntegrator : public SpringMassSysIntegrator<Dim>
+{
+	DECLARE_DIM_TYPES(Dim)
+
+protected:
+
+	using SpringMassSysIntegrator<Dim>::_particles;
+	using SpringMassSysIntegrator<Dim>::_springs;
+	using SpringMassSysIntegrator<Dim>::_incidentSpringOffsets;
+	using SpringMassSysIntegrator<Dim>::_incidentSprings;
+
+	static constexpr int _kIters = 10;
+
+	ParticlesBasedVectorData<Dim> _inertialPositions;
+	ParticlesBasedVectorData<Dim> _newPositions;
+	std::vector<VectorDr> _projections;
+
+	SparseMatrixr _matGlobal;
+	Eigen::SimplicialLDLT<SparseMatrixr> _globalSolver;
+	real _factorizedDt = 0;
+	DofMask _factorizedDofs;
+	VectorXr _rhsGlobal;
+
+public:
+
+	SmsProjectiveDynamicsIntegrator() = default;
+	SmsProjectiveDynamicsIntegrator(const SmsProjectiveDynamicsIntegrator &rhs) = delete;
+	SmsProjectiveDynamicsIntegrator &operator=(const SmsProjectiveDynamicsIntegrator &rhs) = delete;
+	virtual ~SmsProjectiveDynamicsIntegrator() = default;
+
+	virtual void reset(const Particles<Dim> *const particles, const std::vector<Spring> *const springs) override
+	{
+		SpringMassSysIntegrator<Dim>::reset(particles, springs);
+		_inertialPositions.resize(particles);
+		_newPositions.resize(particles);
+		_projections.resize(springs->size());
+		_rhsGlobal.resize(particles->size() * Dim);
+		_factorizedDt = 0;
+	}
+
+	virtual void integrate(
+		const ParticlesVectorAttribute<Dim> &positions,
+		ParticlesVectorAttribute<Dim> &velocities,
+		const real dt,
+		const DofMask &constrainedDofs) override;
+
+protected:
+
+	void factorize(const real dt, const DofMask &constrainedDofs);
+	void predictInertialPositions(
+		const ParticlesVectorAttribute<Dim> &positions,
+		const ParticlesVectorAttribute<Dim> &velocities,
+		const real dt,
+		const DofMask &constrainedDofs);
+	void projectSprings();
+	void solveGlobal(const real dt, const DofMask &constrainedDofs);
+};
+
 }
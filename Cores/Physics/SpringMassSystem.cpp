@@ -18,6 +18,7 @@ void SpringMassSystem<Dim>::writeDescription(YAML::Node &root) const
 		node["data_mode"] = "dynamic";
 		node["primitive_type"] = "point_list";
 		node["indexed"] = false;
+		node["constant_normal"] = Vector3f::Unit(2).eval();
 		node["material"]["diffuse_albedo"] = Vector4f(1, 0, 0, 1);
 		root["objects"].push_back(node);
 	}
@@ -27,70 +28,56 @@ void SpringMassSystem<Dim>::writeDescription(YAML::Node &root) const
 		node["data_mode"] = "semi-dynamic";
 		node["primitive_type"] = "line_list";
 		node["indexed"] = true;
+		node["constant_normal"] = Vector3f::Unit(2).eval();
 		node["material"]["diffuse_albedo"] = Vector4f(0, 0, 1, 1);
 		root["objects"].push_back(node);
 	}
 }
 
 template <int Dim>
-void SpringMassSystem<Dim>::writeFrame(const std::string &frameDir, const bool staticDraw) const
+void SpringMassSystem<Dim>::writeFrame(FrameBuffer &frame, const bool staticDraw) const
 {
 	{ // Write particles.
-		std::ofstream fout(frameDir + "/particles.mesh", std::ios::binary);
+		auto &fout = frame.open("particles.mesh");
 		IO::writeValue(fout, uint(_particles.size()));
-		_particles.forEach([&](const int i) {
-			IO::writeValue(fout, _particles.positions[i].template cast<float>().eval());
-		});
-		if constexpr (Dim == 3) {
-			_particles.forEach([&](const int i) {
-				IO::writeValue(fout, VectorDf::Unit(2).eval());
-			});
-		}
+		IO::writeCast<float>(fout, _particles.positions);
 	}
 	{ // Write springs.
-		std::ofstream fout(frameDir + "/springs.mesh", std::ios::binary);
+		auto &fout = frame.open("springs.mesh");
 		IO::writeValue(fout, uint(_particles.size()));
-		_particles.forEach([&](const int i) {
-			IO::writeValue(fout, _particles.positions[i].template cast<float>().eval());
-		});
-		if constexpr (Dim == 3) {
-			_particles.forEach([&](const int i) {
-				IO::writeValue(fout, VectorDf::Unit(2).eval());
-			});
-		}
+		IO::writeCast<float>(fout, _particles.positions);
 		if (staticDraw) {
 			IO::writeValue(fout, 2 * uint(_springs.size()));
-			for (const auto &spring : _springs) {
-				IO::writeValue(fout, uint(spring.pid0));
-				IO::writeValue(fout, uint(spring.pid1));
-			}
+			IO::writeMapped<uint>(fout, 2 * _springs.size(), [&](const int i) {
+				return uint(i & 1 ? _springs[i >> 1].pid1 : _springs[i >> 1].pid0);
+			});
 		}
 	}
 }
 
 template <int Dim>
-void SpringMassSystem<Dim>::saveFrame(const std::string &frameDir) const
+void SpringMassSystem<Dim>::saveFrame(FrameBuffer &frame) const
 {
 	{ // Save particles.
-		std::ofstream fout(frameDir + "/particles.sav", std::ios::binary);
+		auto &fout = frame.open("particles.sav");
 		_particles.positions.save(fout);
 	}
 	{ // Save velocities.
-		std::ofstream fout(frameDir + "/velocities.sav", std::ios::binary);
+		auto &fout = frame.open("velocities.sav");
 		_velocities.save(fout);
 	}
 }
 
 template <int Dim>
-void SpringMassSystem<Dim>::loadFrame(const std::string &frameDir)
+void SpringMassSystem<Dim>::loadFrame(const ArchivedFrame &frame)
 {
 	{ // Load particles.
-		std::ifstream fin(frameDir + "/particles.sav", std::ios::binary);
+		auto fin = frame.open("particles.sav");
 		_particles.positions.load(fin);
 	}
 	reinitializeParticlesBasedData();
 	{ // Load velocities.
-		std::ifstream fin(frameDir + "/velocities.sav", std::ios::binary);
+		auto fin = frame.open("velocities.sav");
 		_velocities.load(fin);
 	}
 }
@@ -5,8 +5,6 @@
 #include "Physics/SpringMassSysIntegrator.h"
 #include "Structures/ParticlesBasedData.h"
 
-#include <unordered_set>
-
 namespace PhysX {
 
 template <int Dim>
@@ -25,7 +23,7 @@ protected:
 	ParticlesBasedVectorData<Dim> _externalForces;
 
 	std::vector<Spring> _springs;
-	std::unordered_set<int> _constrainedDofs;
+	DofMask _constrainedDofs;
 
 	std::vector<std::unique_ptr<Collider<Dim>>> _colliders;
 
@@ -45,9 +43,9 @@ public:
 
 	virtual int dimension() const override { return Dim; }
 	virtual void writeDescription(YAML::Node &root) const override;
-	virtual void writeFrame(const std::string &frameDir, const bool staticDraw) const override;
-	virtual void saveFrame(const std::string &frameDir) const override;
-	virtual void loadFrame(const std::string &frameDir) override;
+	virtual void writeFrame(FrameBuffer &frame, const bool staticDraw) const override;
+	virtual void saveFrame(FrameBuffer &frame) const override;
+	virtual void loadFrame(const ArchivedFrame &frame) override;
 
 	virtual void initialize() override;
 	virtual void advance(const real dt) override;
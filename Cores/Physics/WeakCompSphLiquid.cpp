@@ -12,22 +12,19 @@ namespace PhysX {
             node["primitive_type"]             = "point_list";
             node["material"]["diffuse_albedo"] = (Vector4f(52, 108, 156, 255) / 255).eval(); // Haijun Blue
             node["indexed"]                    = false;
+            node["constant_normal"]            = Vector3f::Unit(2).eval();
             node["color_map"]["enabled"]       = true;
             root["objects"].push_back(node);
         }
     }
 
     template<int Dim>
-    void WeakCompSphLiquid<Dim>::writeFrame(const std::string & frameDir, const bool staticDraw) const {
+    void WeakCompSphLiquid<Dim>::writeFrame(FrameBuffer & frame, const bool staticDraw) const {
         { // Write particles.
-            std::ofstream fout(frameDir + "/particles.mesh", std::ios::binary);
+            auto & fout = frame.open("particles.mesh");
             IO::writeValue(fout, uint(_particles.size()));
-            _particles.forEach(
-                [&](const int i) { IO::writeValue(fout, _particles.positions[i].template cast<float>().eval()); });
-            if constexpr (Dim == 3) {
-                _particles.forEach([&](const int i) { IO::writeValue(fout, VectorDf::Unit(2).eval()); });
-            }
-            _particles.forEach([&](const int i) { IO::writeValue(fout, float(_velocities[i].norm())); });
+            IO::writeCast<float>(fout, _particles.positions);
+            frame.writeHeats(fout, _particles.size(), [&](const int i) { return float(_velocities[i].norm()); });
         }
     }
 
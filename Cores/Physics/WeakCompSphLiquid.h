@@ -39,7 +39,7 @@ namespace PhysX {
 
     protected:
         virtual void writeDescription(YAML::Node & root) const override;
-        virtual void writeFrame(const std::string & frameDir, const bool staticDraw) const override;
+        virtual void writeFrame(FrameBuffer & frame, const bool staticDraw) const override;
 
         void moveParticles(const real dt) override;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Solvers/MicPreconditioner.h"
 #include "Utilities/Types.h"
 
 #include <fmt/core.h>
@@ -16,15 +17,18 @@ namespace PhysX::IterativeSolver {
 
     template<typename MatrixType> using BiCGSTAB = Eigen::BiCGSTAB<MatrixType, Eigen::IdentityPreconditioner>;
 
-    template<typename MatrixType, typename Solver = CG<MatrixType>>
-    // template <typename MatrixType, typename Solver = ICPCG<MatrixType>>
+    template<typename MatrixType, int Dim>
+    using MICPCG = Eigen::ConjugateGradient<MatrixType, Eigen::Lower | Eigen::Upper, MicPreconditioner<Dim>>;
+
+    template<typename MatrixType, typename Solver>
     inline void solve(
+        Solver &                                           solver,
         const MatrixType &                                 A,
         Eigen::Ref<VectorXr, Eigen::Aligned>               x,
         const Eigen::Ref<const VectorXr, Eigen::Aligned> & b,
         const int                                          maxIterations = -1,
         const real                                         tolerance     = real(1e-6)) {
-        Solver solver(A);
+        solver.compute(A);
         if (solver.info() != Eigen::Success) {
             std::cerr << "Error: [IterativeSolver] failed to factorize matrix." << std::endl;
             std::exit(-1);
@@ -39,4 +43,16 @@ namespace PhysX::IterativeSolver {
         std::cout << fmt::format("{:>6} iters", solver.iterations());
     }
 
+    template<typename MatrixType, typename Solver = CG<MatrixType>>
+    // template <typename MatrixType, typename Solver = ICPCG<MatrixType>>
+    inline void solve(
+        const MatrixType &                                 A,
+        Eigen::Ref<VectorXr, Eigen::Aligned>               x,
+        const Eigen::Ref<const VectorXr, Eigen::Aligned> & b,
+        const int                                          maxIterations = -1,
+        const real                                         tolerance     = real(1e-6)) {
+        Solver solver;
+        solve(solver, A, x, b, maxIterations, tolerance);
+    }
+
 }
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "Utilities/Types.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace PhysX {
+
+    // Modified incomplete Cholesky (MIC(0)) preconditioner for the Poisson equation on a cell-centered grid.
+    //
+    // The matrix must be symmetric, with rows in the natural order of the grid (x-fastest) and at most one
+    // off-diagonal entry per face, i.e., the standard (2 * Dim + 1)-point stencil. The factor is computed from the
+    // stencil coefficients in one sweep. Both the factorization and the triangular solves traverse the grid by
+    // wavefronts (cells with a constant sum of coordinates), which are independent of each other and thus processed
+    // in parallel.
+    template<int Dim> class MicPreconditioner {
+        DECLARE_DIM_TYPES(Dim)
+
+    public:
+        using StorageIndex = typename VectorXr::StorageIndex;
+
+        enum { ColsAtCompileTime = Eigen::Dynamic, MaxColsAtCompileTime = Eigen::Dynamic };
+
+    protected:
+        static constexpr real _kTuning = real(0.97);
+        static constexpr real _kSafety = real(0.25);
+
+        VectorDi                  _size = VectorDi::Zero();
+        std::array<int, Dim>      _strides;
+        VectorXr                  _diag;
+        std::array<VectorXr, Dim> _offDiag; // coefficients between each cell and its neighbor along +axis
+        VectorXr                  _precon;
+        mutable VectorXr          _tmp;
+
+    public:
+        MicPreconditioner() = default;
+
+        void setGridSize(const VectorDi & size) {
+            _size = size;
+            for (int axis = 0, stride = 1; axis < Dim; stride *= _size[axis++]) _strides[axis] = stride;
+        }
+
+        Eigen::Index rows() const { return _precon.size(); }
+        Eigen::Index cols() const { return _precon.size(); }
+
+        template<typename MatType> MicPreconditioner & analyzePattern(const MatType &) { return *this; }
+
+        template<typename MatType> MicPreconditioner & factorize(const MatType & mat) {
+            const int cnt = int(_size.prod());
+            eigen_assert(mat.rows() == cnt && "MicPreconditioner: grid size does not match the matrix");
+            _diag.resize(cnt);
+            _precon.resize(cnt);
+            _tmp.resize(cnt);
+            for (int axis = 0; axis < Dim; axis++) _offDiag[axis].setZero(cnt);
+
+            // Gather the stencil coefficients.
+#ifdef _OPENMP
+#    pragma omp parallel for
+#endif
+            for (int idx = 0; idx < cnt; idx++) {
+                _diag[idx] = 0;
+                for (typename MatType::InnerIterator it(mat, idx); it; ++it) {
+                    const int offset = int(it.index()) - idx;
+                    if (!offset) _diag[idx] = it.value();
+                    else {
+                        for (int axis = 0; axis < Dim; axis++)
+                            if (offset == _strides[axis]) _offDiag[axis][idx] = it.value();
+                    }
+                }
+            }
+            // The coefficients wrapping across rows of the grid are not stencil neighbors.
+            forEachCell([&](const VectorDi & cell, const int idx) {
+                for (int axis = 0; axis < Dim; axis++)
+                    if (cell[axis] == _size[axis] - 1) _offDiag[axis][idx] = 0;
+            });
+
+            // Compute the factor by wavefronts.
+            for (int level = 0; level < numberOfLevels(); level++) {
+                forEachCellOnLevel(level, [&](const VectorDi & cell, const int idx) {
+                    real e = _diag[idx];
+                    for (int axis = 0; axis < Dim; axis++) {
+                        if (!cell[axis]) continue;
+                        const int  nbIdx = idx - _strides[axis];
+                        const real coeff = _offDiag[axis][nbIdx] * _precon[nbIdx];
+                        real       sum   = 0;
+                        for (int other = 0; other < Dim; other++)
+                            if (other != axis) sum += _offDiag[other][nbIdx];
+                        e -= coeff * coeff + _kTuning * _offDiag[axis][nbIdx] * sum * _precon[nbIdx] * _precon[nbIdx];
+                    }
+                    if (e < _kSafety * _diag[idx]) e = _diag[idx];
+                    _precon[idx] = e > 0 ? 1 / std::sqrt(e) : 0;
+                });
+            }
+            return *this;
+        }
+
+        template<typename MatType> MicPreconditioner & compute(const MatType & mat) { return factorize(mat); }
+
+        template<typename Rhs, typename Dest> void _solve_impl(const Rhs & b, Dest & x) const {
+            // Solve L * q = b.
+            for (int level = 0; level < numberOfLevels(); level++) {
+                forEachCellOnLevel(level, [&](const VectorDi & cell, const int idx) {
+                    real t = b[idx];
+                    for (int axis = 0; axis < Dim; axis++) {
+                        if (!cell[axis]) continue;
+                        const int nbIdx = idx - _strides[axis];
+                        t -= _offDiag[axis][nbIdx] * _precon[nbIdx] * _tmp[nbIdx];
+                    }
+                    _tmp[idx] = t * _precon[idx];
+                });
+            }
+            // Solve L^T * x = q.
+            x.resize(b.size());
+            for (int level = numberOfLevels() - 1; level >= 0; level--) {
+                forEachCellOnLevel(level, [&](const VectorDi & cell, const int idx) {
+                    real t = _tmp[idx];
+                    for (int axis = 0; axis < Dim; axis++) {
+                        if (cell[axis] == _size[axis] - 1) continue;
+                        t -= _offDiag[axis][idx] * _precon[idx] * x[idx + _strides[axis]];
+                    }
+                    x[idx] = t * _precon[idx];
+                });
+            }
+        }
+
+        template<typename Rhs> const Eigen::Solve<MicPreconditioner, Rhs> solve(const Eigen::MatrixBase<Rhs> & b) const {
+            return Eigen::Solve<MicPreconditioner, Rhs>(*this, b.derived());
+        }
+
+        Eigen::ComputationInfo info() { return Eigen::Success; }
+
+    protected:
+        int numberOfLevels() const { return _size.sum() - Dim + 1; }
+
+        template<typename Func> void forEachCell(Func && func) const {
+            parallelForEachSlice(0, _size[Dim - 1], [&](const int k) {
+                if constexpr (Dim == 2) {
+                    for (int i = 0; i < _size.x(); i++) func(VectorDi(i, k), i + k * _strides[1]);
+                } else {
+                    for (int j = 0; j < _size.y(); j++)
+                        for (int i = 0; i < _size.x(); i++)
+                            func(VectorDi(i, j, k), i + j * _strides[1] + k * _strides[2]);
+                }
+            });
+        }
+
+        // Cells on the same level are independent of each other in the factorization and the triangular solves.
+        template<typename Func> void forEachCellOnLevel(const int level, Func && func) const {
+            const int lastSlice = _size[Dim - 1] - 1;
+            const int firstSlice = std::max(0, level - (numberOfLevels() - 1 - lastSlice));
+            parallelForEachSlice(firstSlice, std::min(lastSlice, level) + 1, [&](const int k) {
+                const int rest = level - k;
+                if constexpr (Dim == 2) {
+                    func(VectorDi(rest, k), rest + k * _strides[1]);
+                } else {
+                    const int jBegin = std::max(0, rest - (_size.x() - 1));
+                    const int jEnd   = std::min(_size.y() - 1, rest);
+                    for (int j = jBegin; j <= jEnd; j++) {
+                        const int i = rest - j;
+                        func(VectorDi(i, j, k), i + j * _strides[1] + k * _strides[2]);
+                    }
+                }
+            });
+        }
+
+        template<typename Func> static void parallelForEachSlice(const int begin, const int end, Func && func) {
+#ifdef _OPENMP
+#    pragma omp parallel for if (end - begin > 64)
+#endif
+            for (int k = begin; k < end; k++) func(k);
+        }
+    };
+
+} // namespace PhysX
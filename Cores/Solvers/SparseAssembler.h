@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Utilities/Types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace PhysX {
+
+    // Row-wise assembler of sparse matrices with a cached sparsity pattern.
+    //
+    // The caller provides a function `func(row, builder)` which calls `builder.add(col, value)` for every entry of
+    // the row, in a fixed order. Duplicate entries are summed up. The first assembly records the pattern serially;
+    // subsequent assemblies fill the values in place and in parallel. Whenever the sequence of columns of some row
+    // differs from the recorded one, the pattern is rebuilt automatically. Hence `func` must only write data owned by
+    // its row, and must be safe to call more than once for the same row.
+    class SparseAssembler {
+    public:
+        using MatrixType = Eigen::SparseMatrix<real, Eigen::RowMajor>;
+
+        class RowBuilder {
+            friend class SparseAssembler;
+
+        protected:
+            SparseAssembler * const _assembler;
+            const int               _row;
+            int                     _slot;
+            const int               _slotEnd;
+            bool                    _matched = true;
+
+            RowBuilder(SparseAssembler * const assembler, const int row):
+                _assembler(assembler), _row(row), _slot(assembler->_rowSlotOffsets[row]),
+                _slotEnd(assembler->_rowSlotOffsets[size_t(row) + 1]) {}
+
+        public:
+            int row() const { return _row; }
+
+            void add(const int col, const real value) {
+                if (_assembler->_recording) {
+                    _assembler->_slotCols.push_back(col);
+                    _assembler->_slotValues.push_back(value);
+                } else if (_matched && _slot < _slotEnd && _assembler->_slotCols[_slot] == col) {
+                    _assembler->_matrix.valuePtr()[_assembler->_slotEntries[_slot++]] += value;
+                } else _matched = false;
+            }
+        };
+
+    protected:
+        MatrixType _matrix;
+
+        std::vector<int>  _rowSlotOffsets;
+        std::vector<int>  _slotCols;
+        std::vector<int>  _slotEntries;
+        std::vector<real> _slotValues;
+
+        bool _recording = false;
+        bool _dirty     = true;
+
+    public:
+        SparseAssembler() = default;
+
+        SparseAssembler(const SparseAssembler & rhs)             = delete;
+        SparseAssembler & operator=(const SparseAssembler & rhs) = delete;
+        virtual ~SparseAssembler()                               = default;
+
+        const MatrixType & matrix() const { return _matrix; }
+
+        // Forces the pattern to be rebuilt at the next assembly, e.g., after the topology is known to change.
+        void invalidate() { _dirty = true; }
+
+        template<typename Func> void assemble(const int rows, const int cols, Func && func) {
+            if (_dirty || _matrix.rows() != rows || _matrix.cols() != cols || !fill(func)) record(rows, cols, func);
+        }
+
+    protected:
+        template<typename Func> bool fill(Func && func) {
+            const int        rows = int(_matrix.rows());
+            std::atomic_bool matched(true);
+#ifdef _OPENMP
+#    pragma omp parallel for
+#endif
+            for (int row = 0; row < rows; row++) {
+                if (!matched.load(std::memory_order_relaxed)) continue;
+                std::fill(
+                    _matrix.valuePtr() + _matrix.outerIndexPtr()[row],
+                    _matrix.valuePtr() + _matrix.outerIndexPtr()[row + 1],
+                    real(0));
+                RowBuilder builder(this, row);
+                func(row, builder);
+                if (!builder._matched || builder._slot != builder._slotEnd)
+                    matched.store(false, std::memory_order_relaxed);
+            }
+            return matched;
+        }
+
+        template<typename Func> void record(const int rows, const int cols, Func && func) {
+            _slotCols.clear();
+            _slotValues.clear();
+            _rowSlotOffsets.assign(size_t(rows) + 1, 0);
+
+            _recording = true;
+            for (int row = 0; row < rows; row++) {
+                RowBuilder builder(this, row);
+                func(row, builder);
+                _rowSlotOffsets[size_t(row) + 1] = int(_slotCols.size());
+            }
+            _recording = false;
+
+            // Compress the recorded slots into the row-major storage.
+            _slotEntries.resize(_slotCols.size());
+            std::vector<int> rowCols;
+            int              nonZeros = 0;
+            for (int row = 0; row < rows; row++) {
+                rowCols.assign(
+                    _slotCols.begin() + _rowSlotOffsets[row], _slotCols.begin() + _rowSlotOffsets[size_t(row) + 1]);
+                std::sort(rowCols.begin(), rowCols.end());
+                nonZeros += int(std::unique(rowCols.begin(), rowCols.end()) - rowCols.begin());
+            }
+
+            _matrix.resize(rows, cols);
+            _matrix.resizeNonZeros(nonZeros);
+            _matrix.outerIndexPtr()[0] = 0;
+            for (int row = 0, offset = 0; row < rows; row++) {
+                const auto beginSlot = _slotCols.begin() + _rowSlotOffsets[row];
+                const auto endSlot   = _slotCols.begin() + _rowSlotOffsets[size_t(row) + 1];
+                rowCols.assign(beginSlot, endSlot);
+                std::sort(rowCols.begin(), rowCols.end());
+                rowCols.erase(std::unique(rowCols.begin(), rowCols.end()), rowCols.end());
+                std::copy(rowCols.begin(), rowCols.end(), _matrix.innerIndexPtr() + offset);
+                std::fill(_matrix.valuePtr() + offset, _matrix.valuePtr() + offset + rowCols.size(), real(0));
+                for (int slot = _rowSlotOffsets[row]; slot < _rowSlotOffsets[size_t(row) + 1]; slot++) {
+                    const int entry = offset
+                        + int(std::lower_bound(rowCols.begin(), rowCols.end(), _slotCols[slot]) - rowCols.begin());
+                    _slotEntries[slot] = entry;
+                    _matrix.valuePtr()[entry] += _slotValues[slot];
+                }
+                offset += int(rowCols.size());
+                _matrix.outerIndexPtr()[row + 1] = offset;
+            }
+
+            _slotValues.clear();
+            _slotValues.shrink_to_fit();
+            _dirty = false;
+        }
+    };
+
+} // namespace PhysX
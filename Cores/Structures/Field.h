@@ -2,6 +2,8 @@
 
 #include "Utilities/Types.h"
 
+#include <cstddef>
+
 namespace PhysX {
 
 template <int Dim>
@@ -15,6 +17,11 @@ public:
 	virtual ~ScalarField() = default;
 
 	virtual real operator()(const VectorDr &pos) const = 0;
+	// Samples the field at count positions at once. Derived classes override it to amortize the dispatch.
+	virtual void interpolate(const VectorDr *positions, real *values, const size_t count) const
+	{
+		for (size_t i = 0; i < count; i++) values[i] = operator()(positions[i]);
+	}
 	virtual VectorDr gradient(const VectorDr &pos) const = 0;
 	virtual real laplacian(const VectorDr &pos) const = 0;
 };
@@ -30,6 +37,10 @@ public:
 	~VectorField() = default;
 
 	virtual VectorDr operator()(const VectorDr &pos) const = 0;
+	virtual void interpolate(const VectorDr *positions, VectorDr *values, const size_t count) const
+	{
+		for (size_t i = 0; i < count; i++) values[i] = operator()(positions[i]);
+	}
 	virtual real divergence(const VectorDr &pos) const = 0;
 };
 
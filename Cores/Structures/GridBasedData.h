@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Structures/Grid.h"
+#include "Structures/GridLayout.h"
 #include "Utilities/IO.h"
 
 #include <algorithm>
@@ -9,7 +9,7 @@
 
 namespace PhysX {
 
-template <int Dim, typename Type>
+template <int Dim, typename Type, typename Layout = LinearGridLayout<Dim>>
 class GridBasedData
 {
 	DECLARE_DIM_TYPES(Dim)
@@ -17,6 +17,7 @@ class GridBasedData
 protected:
 
 	const Grid<Dim> *_grid = nullptr;
+	Layout _layout;
 	std::vector<Type> _data;
 
 public:
@@ -29,7 +30,16 @@ public:
 	void resize(const Grid<Dim> *const grid, const Type &value = Zero<Type>())
 	{
 		_grid = grid;
-		_data.resize(_grid->dataCount(), value);
+		_layout.resize(_grid);
+		_data.resize(_layout.storageSize(), value);
+	}
+
+	// Copies data stored in another layout.
+	template <typename OtherLayout>
+	void assign(const GridBasedData<Dim, Type, OtherLayout> &rhs)
+	{
+		resize(rhs.grid());
+		parallelForEach([&](const VectorDi &coord) { _data[_layout.index(coord)] = rhs[coord]; });
 	}
 
 	bool isInside(const VectorDi &coord, const int offset) const { return _grid->isInside(coord, offset); }
@@ -39,57 +49,120 @@ public:
 	const Type *data() const { return _data.data(); }
 
 	const Grid<Dim> *grid() const { return _grid; }
+	const Layout &layout() const { return _layout; }
 	real spacing() const { return _grid->spacing(); }
 	real invSpacing() const { return _grid->invSpacing(); }
 	VectorDi size() const { return _grid->dataSize(); }
 	VectorDr origin() const { return _grid->dataOrigin(); }
-	size_t count() const { return _data.size(); }
+	// Indices in [0, count()) address data points only in dense layouts, so the padding of tiled ones is never exposed.
+	size_t count() const
+	{
+		static_assert(Layout::kIsDense, "count() requires a dense layout");
+		return _data.size();
+	}
 	VectorDr position(const VectorDi &coord) const { return _grid->dataPosition(coord); }
 
-	size_t index(const VectorDi &coord) const { return _grid->index(coord); }
-	VectorDi coordinate(const size_t index) const { return _grid->coordinate(index); }
+	size_t index(const VectorDi &coord) const { return _layout.index(coord); }
+	VectorDi coordinate(const size_t index) const { return _layout.coordinate(index); }
 
 	Type &operator[](const size_t index) { return _data[index]; }
 	const Type &operator[](const size_t index) const { return _data[index]; }
-	Type &operator[](const VectorDi &coord) { return _data[_grid->index(coord)]; }
-	const Type &operator[](const VectorDi &coord) const { return _data[_grid->index(coord)]; }
-	const Type &at(const VectorDi &coord) const { return _data[_grid->index(_grid->clamp(coord))]; }
+	Type &operator[](const VectorDi &coord) { return _data[_layout.index(coord)]; }
+	const Type &operator[](const VectorDi &coord) const { return _data[_layout.index(coord)]; }
+	const Type &at(const VectorDi &coord) const { return _data[_layout.index(_grid->clamp(coord))]; }
+
+	void swap(GridBasedData &rhs) { std::swap(_grid, rhs._grid); std::swap(_layout, rhs._layout); _data.swap(rhs._data); }
 
 	void setConstant(const Type &value) { std::fill(_data.begin(), _data.end(), value); }
 	void setZero() { setConstant(Zero<Type>()); }
 
 	template <typename AccType = Type>
-	AccType sum() const { return std::accumulate(_data.begin(), _data.end(), Zero<AccType>()); }
+	AccType sum() const
+	{
+		if constexpr (Layout::kIsDense) return std::accumulate(_data.begin(), _data.end(), Zero<AccType>());
+		else {
+			AccType acc = Zero<AccType>();
+			_layout.forEachIndex([&](const size_t index) { acc += _data[index]; });
+			return acc;
+		}
+	}
 
-	Type min() const { return *std::min_element(_data.begin(), _data.end()); }
-	Type max() const { return *std::max_element(_data.begin(), _data.end()); }
+	Type min() const
+	{
+		if constexpr (Layout::kIsDense) return *std::min_element(_data.begin(), _data.end());
+		else {
+			Type val = _data[_layout.index(VectorDi::Zero())];
+			_layout.forEachIndex([&](const size_t index) { val = std::min(val, _data[index]); });
+			return val;
+		}
+	}
+
+	Type max() const
+	{
+		if constexpr (Layout::kIsDense) return *std::max_element(_data.begin(), _data.end());
+		else {
+			Type val = _data[_layout.index(VectorDi::Zero())];
+			_layout.forEachIndex([&](const size_t index) { val = std::max(val, _data[index]); });
+			return val;
+		}
+	}
 
 	Type absoluteMax() const
 	{
-		auto minmax = std::minmax_element(_data.begin(), _data.end());
-		return std::max(std::abs(*minmax.first), std::abs(*minmax.second));
+		if constexpr (Layout::kIsDense) {
+			auto minmax = std::minmax_element(_data.begin(), _data.end());
+			return std::max(std::abs(*minmax.first), std::abs(*minmax.second));
+		}
+		else return std::max(std::abs(min()), std::abs(max()));
 	}
 
 	real normMax() const
 	{
 		if constexpr (HasSquaredNorm<Type>) {
 			real squaredNormMax = 0;
-			for (const auto &val : _data) {
-				squaredNormMax = std::max(squaredNormMax, val.squaredNorm());
-			}
+			_layout.forEachIndex([&](const size_t index) {
+				squaredNormMax = std::max(squaredNormMax, _data[index].squaredNorm());
+			});
 			return std::sqrt(squaredNormMax);
 		}
 		else return absoluteMax();
 	}
 
-	auto asVectorXr() { return Eigen::Map<VectorXr, Eigen::Aligned>(reinterpret_cast<real *>(_data.data()), _data.size() * (sizeof(Type) / sizeof(real))); }
-	auto asVectorXr() const { return Eigen::Map<const VectorXr, Eigen::Aligned>(reinterpret_cast<const real *>(_data.data()), _data.size() * (sizeof(Type) / sizeof(real))); }
+	auto asVectorXr()
+	{
+		static_assert(Layout::kIsDense, "asVectorXr() requires a dense layout");
+		return Eigen::Map<VectorXr, Eigen::Aligned>(reinterpret_cast<real *>(_data.data()), _data.size() * (sizeof(Type) / sizeof(real)));
+	}
+
+	auto asVectorXr() const
+	{
+		static_assert(Layout::kIsDense, "asVectorXr() requires a dense layout");
+		return Eigen::Map<const VectorXr, Eigen::Aligned>(reinterpret_cast<const real *>(_data.data()), _data.size() * (sizeof(Type) / sizeof(real)));
+	}
 
 	void forEach(const std::function<void(const VectorDi &)> &func) const { _grid->forEach(func); }
 	void parallelForEach(const std::function<void(const VectorDi &)> &func) const { _grid->parallelForEach(func); }
 
-	void load(std::istream &in) { IO::readArray(in, _data.data(), _data.size()); }
-	void save(std::ostream &out) const { IO::writeArray(out, _data.data(), _data.size()); }
+	// Files always store data in the linear layout, so they are interchangeable between layouts.
+	void load(std::istream &in)
+	{
+		if constexpr (Layout::kIsDense) IO::readArray(in, _data.data(), _data.size());
+		else {
+			std::vector<Type> linearData(_grid->dataCount());
+			IO::readArray(in, linearData.data(), linearData.size());
+			parallelForEach([&](const VectorDi &coord) { _data[_layout.index(coord)] = linearData[_grid->index(coord)]; });
+		}
+	}
+
+	void save(std::ostream &out) const
+	{
+		if constexpr (Layout::kIsDense) IO::writeArray(out, _data.data(), _data.size());
+		else {
+			std::vector<Type> linearData(_grid->dataCount());
+			parallelForEach([&](const VectorDi &coord) { linearData[_grid->index(coord)] = _data[_layout.index(coord)]; });
+			IO::writeArray(out, linearData.data(), linearData.size());
+		}
+	}
 };
 
 template <int Dim> using GridBasedScalarData = GridBasedData<Dim, real>;
@@ -1,9 +1,11 @@
 #include "GridBasedScalarField.h"
 
+#include <cmath>
+
 namespace PhysX {
 
-template <int Dim>
-real GridBasedScalarField<Dim>::operator()(const VectorDr &pos) const
+template <int Dim, typename Layout>
+real GridBasedScalarField<Dim, Layout>::operator()(const VectorDr &pos) const
 {
 	real val = 0;
 	for (const auto [coord, weight] : _grid->linearIntrplDataPoints(pos))
@@ -11,8 +13,56 @@ real GridBasedScalarField<Dim>::operator()(const VectorDr &pos) const
 	return val;
 }
 
-template <int Dim>
-Vector<Dim, real> GridBasedScalarField<Dim>::gradientAtDataPoint(const VectorDi &coord) const
+template <int Dim, typename Layout>
+void GridBasedScalarField<Dim, Layout>::interpolate(const VectorDr *positions, real *values, const size_t count) const
+{
+	// Positions are processed in batches stored as structures of arrays, so that the lower data points, the clamped
+	// indices and the weights are computed by vectorized loops; only the gathers of data remain scalar. The arithmetic
+	// is the same as in the pointwise version, thus so are the results. Since layouts are separable, the offset of each
+	// corner is the sum of the per-axis offsets.
+	const VectorDr origin = _grid->dataOrigin();
+	const VectorDi maxCoord = _grid->dataSize() - VectorDi::Ones();
+	const real spacing = _grid->spacing();
+	const real invSpacing = _grid->invSpacing();
+
+	size_t offsets[Dim][2][_kBatchSize];
+	real weights[Dim][2][_kBatchSize];
+	for (size_t begin = 0; begin < count; begin += _kBatchSize) {
+		const int cnt = int(std::min(count - begin, size_t(_kBatchSize)));
+		for (int axis = 0; axis < Dim; axis++) {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+			for (int i = 0; i < cnt; i++) {
+				const real dist = positions[begin + i][axis] - origin[axis];
+				const int lower = int(std::floor(dist * invSpacing));
+				const real frac = (dist - lower * spacing) * invSpacing;
+				offsets[axis][0][i] = _layout.axisOffset(axis, std::clamp(lower, 0, maxCoord[axis]));
+				offsets[axis][1][i] = _layout.axisOffset(axis, std::clamp(lower + 1, 0, maxCoord[axis]));
+				weights[axis][0][i] = 1 - frac;
+				weights[axis][1][i] = frac;
+			}
+		}
+		for (int i = 0; i < cnt; i++) {
+			real val = 0;
+			if constexpr (Dim == 2) {
+				for (int j = 0; j < 2; j++)
+					for (int k = 0; k < 2; k++)
+						val += _data[offsets[0][k][i] + offsets[1][j][i]] * (weights[0][k][i] * weights[1][j][i]);
+			}
+			else {
+				for (int l = 0; l < 2; l++)
+					for (int j = 0; j < 2; j++)
+						for (int k = 0; k < 2; k++)
+							val += _data[offsets[0][k][i] + offsets[1][j][i] + offsets[2][l][i]] * (weights[0][k][i] * weights[1][j][i] * weights[2][l][i]);
+			}
+			values[begin + i] = val;
+		}
+	}
+}
+
+template <int Dim, typename Layout>
+Vector<Dim, real> GridBasedScalarField<Dim, Layout>::gradientAtDataPoint(const VectorDi &coord) const
 {
 	VectorDr acc;
 	for (int i = 0; i < Dim; i++) {
@@ -21,8 +71,8 @@ Vector<Dim, real> GridBasedScalarField<Dim>::gradientAtDataPoint(const VectorDi
 	return acc * real(.5) * _grid->invSpacing();
 }
 
-template <int Dim>
-Vector<Dim, real> GridBasedScalarField<Dim>::gradient(const VectorDr &pos) const
+template <int Dim, typename Layout>
+Vector<Dim, real> GridBasedScalarField<Dim, Layout>::gradient(const VectorDr &pos) const
 {
 	VectorDr grad = VectorDr::Zero();
 	for (const auto [coord, weight] : _grid->linearIntrplDataPoints(pos))
@@ -30,8 +80,8 @@ Vector<Dim, real> GridBasedScalarField<Dim>::gradient(const VectorDr &pos) const
 	return grad;
 }
 
-template <int Dim>
-real GridBasedScalarField<Dim>::laplacianAtDataPoint(const VectorDi &coord) const
+template <int Dim, typename Layout>
+real GridBasedScalarField<Dim, Layout>::laplacianAtDataPoint(const VectorDi &coord) const
 {
 	real acc = 0;
 	const real centerVal = at(coord);
@@ -42,8 +92,8 @@ real GridBasedScalarField<Dim>::laplacianAtDataPoint(const VectorDi &coord) cons
 	return acc * _grid->invSpacing() * _grid->invSpacing();
 }
 
-template <int Dim>
-real GridBasedScalarField<Dim>::laplacian(const VectorDr &pos) const
+template <int Dim, typename Layout>
+real GridBasedScalarField<Dim, Layout>::laplacian(const VectorDr &pos) const
 {
 	real lapl = 0;
 	for (const auto [coord, weight] : _grid->linearIntrplDataPoints(pos))
@@ -53,5 +103,8 @@ real GridBasedScalarField<Dim>::laplacian(const VectorDr &pos) const
 
 template class GridBasedScalarField<2>;
 template class GridBasedScalarField<3>;
+template class GridBasedScalarField<2, TiledGridLayout<2>>;
+template class GridBasedScalarField<3, TiledGridLayout<3>>;
+template class GridBasedScalarField<3, TiledGridLayout<3, 3>>;
 
 }
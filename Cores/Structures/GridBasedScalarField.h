@@ -5,25 +5,30 @@
 
 namespace PhysX {
 
-template <int Dim>
-class GridBasedScalarField final : public ScalarField<Dim>, public GridBasedScalarData<Dim>
+template <int Dim, typename Layout = LinearGridLayout<Dim>>
+class GridBasedScalarField final : public ScalarField<Dim>, public GridBasedData<Dim, real, Layout>
 {
 	DECLARE_DIM_TYPES(Dim)
 
 protected:
 
-	using GridBasedScalarData<Dim>::_grid;
+	static constexpr int _kBatchSize = 64;
+
+	using GridBasedData<Dim, real, Layout>::_grid;
+	using GridBasedData<Dim, real, Layout>::_layout;
+	using GridBasedData<Dim, real, Layout>::_data;
 
 public:
 
-	using GridBasedScalarData<Dim>::at;
+	using GridBasedData<Dim, real, Layout>::at;
 
-	GridBasedScalarField(const Grid<Dim> *const grid, const real value = 0) : GridBasedScalarData<Dim>(grid, value) { }
+	GridBasedScalarField(const Grid<Dim> *const grid, const real value = 0) : GridBasedData<Dim, real, Layout>(grid, value) { }
 
 	GridBasedScalarField() = default;
 	virtual ~GridBasedScalarField() = default;
 
 	virtual real operator()(const VectorDr &pos) const override;
+	virtual void interpolate(const VectorDr *positions, real *values, const size_t count) const override;
 	VectorDr gradientAtDataPoint(const VectorDi &coord) const;
 	virtual VectorDr gradient(const VectorDr &pos) const override;
 	real laplacianAtDataPoint(const VectorDi &coord) const;
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Structures/Grid.h"
+
+#include <array>
+
+namespace PhysX {
+
+// Layouts map the data points of a grid to the storage of GridBasedData.
+//
+// Both layouts are separable, i.e., the offset of a data point is the sum of per-axis offsets of its coordinates,
+// which lets interpolation kernels compute the offsets of all axes independently. The storage of a layout may exceed
+// the number of data points, in which case indices are not contiguous and kIsDense is false.
+
+// Lexicographic order with x fastest, identical to Grid::index.
+template <int Dim>
+class LinearGridLayout
+{
+	DECLARE_DIM_TYPES(Dim)
+
+public:
+
+	static constexpr bool kIsDense = true;
+
+protected:
+
+	const Grid<Dim> *_grid = nullptr;
+	std::array<size_t, Dim> _strides = { };
+
+public:
+
+	void resize(const Grid<Dim> *const grid)
+	{
+		_grid = grid;
+		for (size_t axis = 0, stride = 1; axis < Dim; stride *= _grid->dataSize()[axis++])
+			_strides[axis] = stride;
+	}
+
+	size_t storageSize() const { return _grid->dataCount(); }
+	size_t axisOffset(const int axis, const int x) const { return x * _strides[axis]; }
+	size_t index(const VectorDi &coord) const { return _grid->index(coord); }
+	VectorDi coordinate(const size_t index) const { return _grid->coordinate(index); }
+
+	template <typename Func>
+	void forEachIndex(Func &&func) const
+	{
+		for (size_t index = 0; index < storageSize(); index++)
+			func(index);
+	}
+};
+
+// Tiles of (2^TileBits)^Dim data points stored contiguously, tiles in lexicographic order and data points in
+// lexicographic order inside each tile. Stencils along y and z then mostly stay within a tile instead of jumping a
+// whole row or slice. The grid is padded to whole tiles, and the padding is never visited.
+template <int Dim, int TileBits = 2>
+class TiledGridLayout
+{
+	DECLARE_DIM_TYPES(Dim)
+
+public:
+
+	static constexpr bool kIsDense = false;
+
+protected:
+
+	static constexpr int _kTileLength = 1 << TileBits;
+	static constexpr int _kTileVolume = MathFunc::pow(_kTileLength, Dim);
+
+	const Grid<Dim> *_grid = nullptr;
+	VectorDi _tileCount = VectorDi::Zero();
+	std::array<size_t, Dim> _tileStrides = { };
+
+public:
+
+	void resize(const Grid<Dim> *const grid)
+	{
+		_grid = grid;
+		_tileCount = (_grid->dataSize() + VectorDi::Ones() * (_kTileLength - 1)) / _kTileLength;
+		for (size_t axis = 0, stride = _kTileVolume; axis < Dim; stride *= _tileCount[axis++])
+			_tileStrides[axis] = stride;
+	}
+
+	size_t storageSize() const { return _tileCount.template cast<size_t>().prod() * _kTileVolume; }
+	size_t axisOffset(const int axis, const int x) const { return (x >> TileBits) * _tileStrides[axis] + (size_t(x & (_kTileLength - 1)) << (TileBits * axis)); }
+
+	size_t index(const VectorDi &coord) const
+	{
+		size_t index = 0;
+		for (int axis = 0; axis < Dim; axis++)
+			index += axisOffset(axis, coord[axis]);
+		return index;
+	}
+
+	VectorDi coordinate(const size_t index) const
+	{
+		size_t tile = index / _kTileVolume;
+		const size_t local = index % _kTileVolume;
+		VectorDi coord;
+		for (int axis = 0; axis < Dim; axis++) {
+			coord[axis] = int(tile % _tileCount[axis]) * _kTileLength + int(local >> (TileBits * axis) & (_kTileLength - 1));
+			tile /= _tileCount[axis];
+		}
+		return coord;
+	}
+
+	template <typename Func>
+	void forEachIndex(Func &&func) const
+	{
+		for (size_t index = 0; index < storageSize(); index++)
+			if (_grid->isValid(coordinate(index))) func(index);
+	}
+};
+
+}
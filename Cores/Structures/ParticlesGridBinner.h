@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Structures/Grid.h"
+#include "Structures/ParticlesAttribute.h"
+
+#include <vector>
+
+namespace PhysX {
+
+// Bins particles by the lower data point of their linear interpolation stencil on a grid.
+//
+// Bins are stored compactly, and particles in each bin are in increasing order of indices, so that a gather over bins
+// visits particles in the same order as a serial loop does. Lower data points are clamped to the grid padded by
+// _kHalo layers.
+template <int Dim>
+class ParticlesGridBinner
+{
+	DECLARE_DIM_TYPES(Dim)
+
+protected:
+
+	static constexpr int _kHalo = 2;
+
+	const Grid<Dim> *_grid = nullptr;
+	VectorDi _binSize = VectorDi::Zero();
+
+	std::vector<int> _keys;
+	std::vector<int> _offsets;
+	std::vector<int> _indices;
+
+public:
+
+	ParticlesGridBinner() = default;
+
+	ParticlesGridBinner(const ParticlesGridBinner &rhs) = delete;
+	ParticlesGridBinner &operator=(const ParticlesGridBinner &rhs) = delete;
+	virtual ~ParticlesGridBinner() = default;
+
+	const Grid<Dim> *grid() const { return _grid; }
+
+	void reset(const Grid<Dim> *const grid, const ParticlesVectorAttribute<Dim> &positions)
+	{
+		_grid = grid;
+		_binSize = _grid->dataSize() + VectorDi::Ones() * (_kHalo * 2);
+		const int cnt = int(positions.size());
+		_keys.resize(cnt);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < cnt; i++)
+			_keys[i] = binIndex(_grid->getLinearLower(positions[i]));
+
+		// Counting sort, which is stable.
+		_offsets.assign(size_t(_binSize.prod()) + 1, 0);
+		for (int i = 0; i < cnt; i++) _offsets[_keys[i] + 1]++;
+		for (size_t bin = 0; bin + 1 < _offsets.size(); bin++) _offsets[bin + 1] += _offsets[bin];
+		_indices.resize(cnt);
+		std::vector<int> cursors(_offsets.begin(), _offsets.end() - 1);
+		for (int i = 0; i < cnt; i++) _indices[cursors[_keys[i]]++] = i;
+	}
+
+	// Returns the range of indices of particles whose lower data point is the given one.
+	std::pair<const int *, const int *> bin(const VectorDi &lower) const
+	{
+		if (((lower.array() + _kHalo) < 0).any() || ((lower.array() + _kHalo) >= _binSize.array()).any()) return { nullptr, nullptr };
+		const int idx = binIndex(lower);
+		return { _indices.data() + _offsets[idx], _indices.data() + _offsets[size_t(idx) + 1] };
+	}
+
+protected:
+
+	int binIndex(const VectorDi &lower) const
+	{
+		const VectorDi coord = (lower + VectorDi::Ones() * _kHalo).cwiseMax(0).cwiseMin(_binSize - VectorDi::Ones());
+		if constexpr (Dim == 2) return coord.x() + _binSize.x() * coord.y();
+		else return coord.x() + _binSize.x() * (coord.y() + _binSize.y() * coord.z());
+	}
+};
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Utilities/Types.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace PhysX {
+
+class ScratchPoolBase
+{
+protected:
+
+	static inline std::atomic<size_t> _allocationCount = 0;
+
+public:
+
+	// Number of buffers allocated by all pools so far. It stays constant over steady-state steps.
+	static size_t allocationCount() { return _allocationCount; }
+};
+
+// A pool of scratch data keyed by grid.
+//
+// Buffers are acquired through handles, which give them back to the pool when destroyed. The contents of an acquired
+// buffer are unspecified. The typical use is double buffering: compute into a scratch buffer and swap it with the
+// target, so that the old data goes back to the pool and is reused by the next call instead of being reallocated.
+template <typename DataType>
+class ScratchPool final : public ScratchPoolBase
+{
+public:
+
+	class Handle final
+	{
+		friend class ScratchPool;
+
+	protected:
+
+		ScratchPool *const _pool;
+		const void *const _key;
+		std::unique_ptr<DataType> _data;
+
+		Handle(ScratchPool *const pool, const void *const key, std::unique_ptr<DataType> data) : _pool(pool), _key(key), _data(std::move(data)) { }
+
+	public:
+
+		Handle(const Handle &rhs) = delete;
+		Handle &operator=(const Handle &rhs) = delete;
+		~Handle() { _pool->release(_key, std::move(_data)); }
+
+		DataType &operator*() const { return *_data; }
+		DataType *operator->() const { return _data.get(); }
+	};
+
+protected:
+
+	std::mutex _mutex;
+	std::unordered_map<const void *, std::vector<std::unique_ptr<DataType>>> _buffers;
+
+public:
+
+	ScratchPool() = default;
+	ScratchPool(const ScratchPool &rhs) = delete;
+	ScratchPool &operator=(const ScratchPool &rhs) = delete;
+	~ScratchPool() = default;
+
+	template <typename GridType>
+	Handle acquire(const GridType *const grid)
+	{
+		std::unique_ptr<DataType> data;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if (auto &buffers = _buffers[grid]; !buffers.empty()) {
+				data = std::move(buffers.back());
+				buffers.pop_back();
+			}
+		}
+		if (data) data->resize(grid);
+		else {
+			data = std::make_unique<DataType>(grid);
+			_allocationCount++;
+		}
+		return Handle(this, grid, std::move(data));
+	}
+
+protected:
+
+	void release(const void *const key, std::unique_ptr<DataType> data)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_buffers[key].push_back(std::move(data));
+	}
+};
+
+}
@@ -45,6 +45,13 @@ public:
 	GridBasedData<Dim, Type> &operator[](const int axis) { return _components[axis]; }
 	const GridBasedData<Dim, Type> &operator[](const int axis) const { return _components[axis]; }
 
+	void swap(StaggeredGridBasedData &rhs)
+	{
+		std::swap(_grid, rhs._grid);
+		for (int axis = 0; axis < Dim; axis++)
+			_components[axis].swap(rhs._components[axis]);
+	}
+
 	void setConstant(const Type &value) { for (int axis = 0; axis < Dim; axis++) _components[axis].setConstant(value); }
 	void setZero() { setConstant(Zero<Type>()); }
 
@@ -11,6 +11,20 @@ Vector<Dim, real> StaggeredGridBasedVectorField<Dim>::operator()(const VectorDr
 	return vec;
 }
 
+template <int Dim>
+void StaggeredGridBasedVectorField<Dim>::interpolate(const VectorDr *positions, VectorDr *values, const size_t count) const
+{
+	real componentValues[_kBatchSize];
+	for (size_t begin = 0; begin < count; begin += _kBatchSize) {
+		const int cnt = int(std::min(count - begin, size_t(_kBatchSize)));
+		for (int axis = 0; axis < Dim; axis++) {
+			_components[axis].interpolate(positions + begin, componentValues, cnt);
+			for (int i = 0; i < cnt; i++)
+				values[begin + i][axis] = componentValues[i];
+		}
+	}
+}
+
 template <int Dim>
 real StaggeredGridBasedVectorField<Dim>::divergenceAtCellCenter(const VectorDi &cell) const
 {
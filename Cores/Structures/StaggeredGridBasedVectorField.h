@@ -13,6 +13,8 @@ class StaggeredGridBasedVectorField final : public VectorField<Dim>
 
 protected:
 
+	static constexpr int _kBatchSize = 64;
+
 	const StaggeredGrid<Dim> *_grid = nullptr;
 	std::array<GridBasedScalarField<Dim>, Dim> _components;
 
@@ -46,10 +48,18 @@ public:
 	const GridBasedScalarField<Dim> &operator[](const int axis) const { return _components[axis]; }
 
 	virtual VectorDr operator()(const VectorDr &pos) const override;
+	virtual void interpolate(const VectorDr *positions, VectorDr *values, const size_t count) const override;
 
 	real divergenceAtCellCenter(const VectorDi &cell) const;
 	virtual real divergence(const VectorDr &pos) const override;
 
+	void swap(StaggeredGridBasedVectorField &rhs)
+	{
+		std::swap(_grid, rhs._grid);
+		for (int axis = 0; axis < Dim; axis++)
+			_components[axis].swap(rhs._components[axis]);
+	}
+
 	void setConstant(const VectorDr &value) { for (int axis = 0; axis < Dim; axis++) _components[axis].setConstant(value[axis]); }
 	void setZero() { setConstant(VectorDr::Zero()); }
 
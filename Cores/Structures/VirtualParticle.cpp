@@ -2,8 +2,8 @@
 
 #include "Structures/StaggeredGrid.h"
 
-#include "Solvers/IterativeSolver.h"
-
+#include <algorithm>
+#include <limits>
 #include <numbers>
 
 #include <cmath>
@@ -12,8 +12,7 @@ namespace PhysX {
     template<int Dim>
     VirtualParticle<Dim>::VirtualParticle(
         const StaggeredGrid<Dim> & grid, const real radius, const size_t cnt, const VectorDr & pos):
-        _grid(grid),
-        _weight(_grid.nodeGrid(), 0), SmoothedParticles<Dim>(radius, cnt, pos), _alpha_0(-1e6) {}
+        SmoothedParticles<Dim>(radius, cnt, pos), _grid(grid), _nodeMarks(_grid.nodeCount(), 0), _alpha_0(-1e6) {}
 
     template<int Dim> void VirtualParticle<Dim>::computeDensities(const SmoothedParticles<Dim> & realParticles) {
         densities._data.resize(positions.size());
@@ -43,33 +42,96 @@ namespace PhysX {
     }
 
     template<int Dim> void VirtualParticle<Dim>::generateParticles(const SmoothedParticles<Dim> & realParticles) {
-        clear();
-
-        _weight.parallelForEach([&](const VectorDi & I) {
-            VectorDr p_I = _weight.position(I);
-            _weight[I]   = 0;
+        // Only nodes near real particles may carry weights, so the empty part of the domain is never visited.
+        collectCandidateNodes(realParticles);
+
+        const Grid<Dim> * const nodeGrid = _grid.nodeGrid();
+        const int               cnt      = int(_candidateNodes.size());
+        _candidateFlags.resize(cnt);
+#ifdef _OPENMP
+#    pragma omp parallel for
+#endif
+        for (int c = 0; c < cnt; c++) {
+            const VectorDr p_I    = nodeGrid->dataPosition(nodeGrid->coordinate(_candidateNodes[c]));
+            real           weight = 0;
             realParticles.forEachNearby(
-                p_I, [&](int j, const VectorDr & p_j) { _weight[I] += realParticles.kernel(p_I - p_j); });
-        });
-
-        _weight.forEach([&](const VectorDi & I) {
-            if (_weight[I] > 1e-6) add(_weight.position(I));
-        });
+                p_I, [&](int j, const VectorDr & p_j) { weight += realParticles.kernel(p_I - p_j); });
+            _candidateFlags[c] = weight > 1e-6;
+        }
+
+        // Compact the weighted nodes by an exclusive prefix sum over blocks of candidates.
+        const int blockCnt = (cnt + _kCompactionBlockSize - 1) / _kCompactionBlockSize;
+        _blockOffsets.assign(size_t(blockCnt) + 1, 0);
+#ifdef _OPENMP
+#    pragma omp parallel for
+#endif
+        for (int b = 0; b < blockCnt; b++) {
+            const int end = std::min((b + 1) * _kCompactionBlockSize, cnt);
+            for (int c = b * _kCompactionBlockSize; c < end; c++) _blockOffsets[size_t(b) + 1] += _candidateFlags[c];
+        }
+        for (int b = 0; b < blockCnt; b++) _blockOffsets[size_t(b) + 1] += _blockOffsets[b];
+
+        positions._data.resize(_blockOffsets[blockCnt]);
+        _nodes.resize(_blockOffsets[blockCnt]);
+#ifdef _OPENMP
+#    pragma omp parallel for
+#endif
+        for (int b = 0; b < blockCnt; b++) {
+            const int end = std::min((b + 1) * _kCompactionBlockSize, cnt);
+            for (int c = b * _kCompactionBlockSize, I = _blockOffsets[b]; c < end; c++) {
+                if (!_candidateFlags[c]) continue;
+                _nodes[I]       = _candidateNodes[c];
+                positions[I++] = nodeGrid->dataPosition(nodeGrid->coordinate(_candidateNodes[c]));
+            }
+        }
 
         resetNearbySearcher();
 
         computeInfo(realParticles);
     }
 
+    template<int Dim>
+    void VirtualParticle<Dim>::collectCandidateNodes(const SmoothedParticles<Dim> & realParticles) {
+        const Grid<Dim> * const nodeGrid = _grid.nodeGrid();
+        const VectorDi          maxNode  = nodeGrid->dataSize() - VectorDi::Ones();
+
+        // Bin real particles by the lower nodes of their cells. Particles out of the grid are clamped to its border,
+        // which keeps every node within their kernel supports.
+        _occupiedNodes.clear();
+        realParticles.forEach([&](const int j) {
+            const VectorDi lower = nodeGrid->getLinearLower(realParticles.positions[j]).cwiseMax(0).cwiseMin(maxNode);
+            const int      node  = int(nodeGrid->index(lower));
+            if (!_nodeMarks[node]) _nodeMarks[node] = 1, _occupiedNodes.push_back(node);
+        });
+        for (const int node : _occupiedNodes) _nodeMarks[node] = 0;
+
+        // Dilate occupied cells by the kernel radius.
+        const int span = int(std::ceil(realParticles.kernelRadius() * nodeGrid->invSpacing()));
+        _candidateNodes.clear();
+        for (const int node : _occupiedNodes) {
+            const VectorDi lower  = (nodeGrid->coordinate(node) - VectorDi::Ones() * span).cwiseMax(0);
+            const VectorDi extent = (nodeGrid->coordinate(node) + VectorDi::Ones() * (span + 1)).cwiseMin(maxNode)
+                - lower + VectorDi::Ones();
+            for (int k = 0; k < extent.prod(); k++) {
+                VectorDi coord = lower;
+                for (int axis = 0, rest = k; axis < Dim; rest /= extent[axis++]) coord[axis] += rest % extent[axis];
+                const int candidate = int(nodeGrid->index(coord));
+                if (!_nodeMarks[candidate]) _nodeMarks[candidate] = 1, _candidateNodes.push_back(candidate);
+            }
+        }
+        for (const int node : _candidateNodes) _nodeMarks[node] = 0;
+
+        // Virtual particles keep the lexicographic order of nodes.
+        std::sort(_candidateNodes.begin(), _candidateNodes.end());
+    }
+
     template<int Dim>
     void VirtualParticle<Dim>::setAlpha(const SmoothedParticles<Dim> & realParticles, const real target_rho) {
         generateParticles(realParticles);
 
         calculateCoef(target_rho);
 
-        _alpha_0 = _matLaplacian.diagonal().maxCoeff();
-
-        std::cout << _alpha_0 << std::endl;
+        _alpha_0 = _diagonals.maxCoeff();
     }
 
     template<int Dim>
@@ -96,6 +158,13 @@ namespace PhysX {
         _divergence.resize(this);
         _velocities.resize(this);
 
+        // Warm start from the pressures solved at the same nodes in the last step.
+        parallelForEach([&](const int I) {
+            const auto iter  = std::lower_bound(_lastNodes.begin(), _lastNodes.end(), _nodes[I]);
+            const bool found = iter != _lastNodes.end() && *iter == _nodes[I];
+            _pressures[I]    = found ? _lastPressures[iter - _lastNodes.begin()] : 0;
+        });
+
         calculateVelocity(velocity, boundary_velocity, real_particle, boundary_particle);
         calculateDiv(velocity, boundary_velocity, real_particle, boundary_particle, target_rho);
 
@@ -103,8 +172,59 @@ namespace PhysX {
     }
 
     template<int Dim> void VirtualParticle<Dim>::solveLinearSystem() {
-        std::cout << "Divergence: " << _divergence[0] << std::endl;
-        IterativeSolver::solve(_matLaplacian, _pressures.asVectorXr(), _divergence.asVectorXr());
+        // Conjugate gradient with the Jacobi preconditioner, stopping by the same criterion as IterativeSolver.
+        auto       x        = _pressures.asVectorXr();
+        const auto b        = _divergence.asVectorXr();
+        const int  maxIters = int(positions.size()) * 2;
+        const real rhsNorm2 = b.squaredNorm();
+        int        iters    = 0;
+
+        if (rhsNorm2 == 0) x.setZero();
+        else {
+            const real tolerance =
+                std::max(_kSolverTolerance, std::numeric_limits<real>::epsilon() / std::sqrt(rhsNorm2));
+            const real threshold = tolerance * tolerance * rhsNorm2;
+
+            applyLaplacian(x, _product);
+            _residual       = b - _product;
+            _preconditioned = _residual.cwiseQuotient(_diagonals);
+            _direction      = _preconditioned;
+            real rz         = _residual.dot(_preconditioned);
+            while (iters < maxIters && _residual.squaredNorm() >= threshold) {
+                applyLaplacian(_direction, _product);
+                const real alpha = rz / _direction.dot(_product);
+                x += alpha * _direction;
+                _residual -= alpha * _product;
+                _preconditioned  = _residual.cwiseQuotient(_diagonals);
+                const real newRz = _residual.dot(_preconditioned);
+                _direction       = _preconditioned + newRz / rz * _direction;
+                rz               = newRz;
+                iters++;
+            }
+        }
+
+        _lastNodes = _nodes;
+        _lastPressures.assign(_pressures.data(), _pressures.data() + _pressures.size());
+
+        if (_stats) {
+            _stats->particleCount = positions.size();
+            _stats->nonZeros      = _neighbors.size() + positions.size();
+            _stats->iterations    = iters;
+            _stats->residual      = rhsNorm2 ? _residual.norm() / std::sqrt(rhsNorm2) : 0;
+            _stats->maxDivergence = b.size() ? b.cwiseAbs().maxCoeff() : 0;
+            _stats->minDiagonal   = _alpha_0;
+        }
+    }
+
+    template<int Dim>
+    void VirtualParticle<Dim>::applyLaplacian(const Eigen::Ref<const VectorXr> & x, VectorXr & y) const {
+        y.resize(x.size());
+        parallelForEach([&](const int I) {
+            real sum = _diagonals[I] * x[I];
+            for (int k = _neighborOffsets[I]; k < _neighborOffsets[size_t(I) + 1]; k++)
+                sum += _neighborCoeffs[k] * x[_neighbors[k]];
+            y[I] = sum;
+        });
     }
 
     template<int Dim>
@@ -147,25 +267,37 @@ namespace PhysX {
     }
 
     template<int Dim> void VirtualParticle<Dim>::calculateCoef(const real target_rho) {
-        _matLaplacian.resize(positions.size(), positions.size());
-        _coefficients.clear();
-        forEach([&](const int I) {
+        // Cache neighbor lists in two passes, counting and then filling them in parallel.
+        const int cnt = int(positions.size());
+        _neighborOffsets.resize(size_t(cnt) + 1);
+        _neighborOffsets[0] = 0;
+        parallelForEach([&](const int I) {
+            int nbCnt = 0;
+            forEachNearby(positions[I], [&](int J, const VectorDr &) {
+                if (J != I) nbCnt++;
+            });
+            _neighborOffsets[size_t(I) + 1] = nbCnt;
+        });
+        for (int I = 0; I < cnt; I++) _neighborOffsets[size_t(I) + 1] += _neighborOffsets[I];
+
+        _neighbors.resize(_neighborOffsets[cnt]);
+        _neighborCoeffs.resize(_neighborOffsets[cnt]);
+        _diagonals.resize(cnt);
+        parallelForEach([&](const int I) {
             VectorDr p_I = positions[I];
             double   sum = 0;
+            int      k   = _neighborOffsets[I];
             forEachNearby(p_I, [&](int J, const VectorDr & p_J) {
+                if (J == I) return;
                 double r_ij     = (p_I - p_J).norm();
                 double alpha_ij = 2. * volumes[J] * firstDerivativeKernel(r_ij) / (r_ij + 1e-6);
                 sum -= alpha_ij;
-                _coefficients.push_back({ I, J, alpha_ij });
+                _neighbors[k]        = J;
+                _neighborCoeffs[k++] = alpha_ij;
             });
-            //_coefficients.push_back({ I, I, sum });
-            _coefficients.push_back({ I, I, std::max(sum, _alpha_0) });
+            // _diagonals[I] = sum;
+            _diagonals[I] = std::max(sum, _alpha_0);
         });
-
-        _matLaplacian.setFromTriplets(_coefficients.begin(), _coefficients.end());
-
-        std::cout << "P[0, 0]: " << _matLaplacian.coeff(0, 0) << std::endl;
-        std::cout << "P[0, 1]: " << _matLaplacian.coeff(0, 1) << std::endl;
     }
 
     template<int Dim>
@@ -10,6 +10,16 @@
 
 namespace PhysX {
 
+    // Diagnostics of the pressure projection by virtual particles, only collected when requested by setStats.
+    struct VirtualProjectionStats {
+        size_t particleCount = 0;
+        size_t nonZeros      = 0; // of the Laplacian, including the diagonal
+        int    iterations    = 0;
+        real   residual      = 0; // relative to the norm of the right-hand side
+        real   maxDivergence = 0;
+        real   minDiagonal   = 0; // the lower bound of diagonals, set by setAlpha
+    };
+
     template<int Dim> class VirtualParticle : public SmoothedParticles<Dim> {
         DECLARE_DIM_TYPES(Dim)
 
@@ -45,8 +55,21 @@ namespace PhysX {
         using SmoothedParticles<Dim>::firstDerivativeKernel;
 
     private:
+        static constexpr int  _kCompactionBlockSize = 4096;
+        static constexpr real _kSolverTolerance     = real(1e-6);
+
         const StaggeredGrid<Dim> _grid;
-        GridBasedScalarData<Dim> _weight;
+
+        std::vector<int>   _occupiedNodes;  // lower nodes of cells containing real particles
+        std::vector<int>   _candidateNodes; // nodes within the kernel support of occupied cells, in increasing order
+        std::vector<uchar> _candidateFlags;
+        std::vector<uchar> _nodeMarks;      // all zeros between generations
+        std::vector<int>   _blockOffsets;
+        std::vector<int>   _nodes;          // of virtual particles
+
+        // Pressures of the last projection, indexed by the nodes of virtual particles for warm starts.
+        std::vector<int>  _lastNodes;
+        std::vector<real> _lastPressures;
 
         real _alpha_0;
         real kappa;
@@ -56,8 +79,19 @@ namespace PhysX {
         ParticlesBasedScalarField<Dim> _pressures;
         ParticlesBasedScalarField<Dim> _divergence;
 
-        std::vector<Tripletr> _coefficients;
-        SparseMatrixr         _matLaplacian;
+        // The Laplacian is applied matrix-free, with off-diagonal entries over cached neighbor lists.
+        std::vector<int>  _neighborOffsets;
+        std::vector<int>  _neighbors;
+        std::vector<real> _neighborCoeffs;
+        VectorXr          _diagonals;
+
+        // Scratch vectors of the Jacobi-preconditioned conjugate gradient solver.
+        VectorXr _residual;
+        VectorXr _preconditioned;
+        VectorXr _direction;
+        VectorXr _product;
+
+        VirtualProjectionStats * _stats = nullptr;
 
     public:
         VirtualParticle(
@@ -75,6 +109,7 @@ namespace PhysX {
 
         void setAlpha(const SmoothedParticles<Dim> & realParticles, const real target_rho);
         void setKappa(const real k) { kappa = k; }
+        void setStats(VirtualProjectionStats * const stats) { _stats = stats; }
 
         void generateParticles(const SmoothedParticles<Dim> & realParticles);
 
@@ -87,6 +122,8 @@ namespace PhysX {
             const real                             dt);
 
     protected:
+        void collectCandidateNodes(const SmoothedParticles<Dim> & realParticles);
+
         void buildLinearSystem(
             const ParticlesBasedVectorField<Dim> & velocity,
             const ParticlesBasedVectorField<Dim> & boundary_velocity,
@@ -94,6 +131,7 @@ namespace PhysX {
             const BoundaryParticles<Dim> &         boundary_particle,
             const real                             target_rho);
         void solveLinearSystem();
+        void applyLaplacian(const Eigen::Ref<const VectorXr> & x, VectorXr & y) const;
         void applyPressureGradient(
             ParticlesBasedVectorField<Dim> &       velocity,
             const ParticlesBasedVectorField<Dim> & boundary_velocity,
@@ -0,0 +1,147 @@
+#include "FrameArchive.h"
+
+#include "Utilities/IO.h"
+#include "Utilities/MappedFile.h"
+
+#include <fmt/core.h>
+
+#include <filesystem>
+#include <iostream>
+
+namespace PhysX {
+
+std::string_view ArchivedFrame::find(const std::string_view name) const
+{
+	for (const auto &[sectionName, bytes] : _sections)
+		if (sectionName == name) return bytes;
+	return {};
+}
+
+std::istringstream ArchivedFrame::open(const std::string &name) const
+{
+	for (const auto &[sectionName, bytes] : _sections)
+		if (sectionName == name) return std::istringstream(std::string(bytes), std::ios::binary);
+	std::cerr << fmt::format("Error: [ArchivedFrame] cannot find section {}.", name) << std::endl;
+	std::exit(-1);
+}
+
+bool FrameArchive::open(const std::string &fileName)
+{
+	_frames.clear();
+	_archived.clear();
+	_validSize = 0;
+	if (!_file.open(fileName)) return false;
+
+	const std::string_view bytes = _file.bytes();
+	if (bytes.size() < _kHeaderSize || bytes.substr(0, sizeof(_kMagic)) != std::string_view(_kMagic, sizeof(_kMagic)))
+		return false;
+	std::string_view header = bytes.substr(sizeof(_kMagic), sizeof(uint));
+	uint version;
+	IO::readValue(header, version);
+	if (version != _kVersion) return false;
+
+	// Index chunks until the end or a partially written one.
+	size_t offset = _kHeaderSize;
+	while (bytes.size() - offset >= _kChunkHeaderSize) {
+		std::string_view in = bytes.substr(offset);
+		uint frame, sectionCnt;
+		uint64_t chunkSize;
+		IO::readValue(in, frame);
+		IO::readValue(in, sectionCnt);
+		IO::readValue(in, chunkSize);
+		if (chunkSize > in.size()) break;
+		in = in.substr(0, chunkSize);
+
+		ArchivedFrame archived;
+		std::vector<uint64_t> sizes(sectionCnt);
+		bool valid = true;
+		for (uint i = 0; i < sectionCnt && valid; i++) {
+			uint nameSize;
+			IO::readValue(in, sizes[i]);
+			IO::readValue(in, nameSize);
+			valid = nameSize <= in.size();
+			if (valid) archived._sections.push_back({ in.substr(0, nameSize), {} });
+			in.remove_prefix(std::min(size_t(nameSize), in.size()));
+		}
+		for (uint i = 0; i < sectionCnt && valid; i++) {
+			valid = sizes[i] <= in.size();
+			if (valid) archived._sections[i].second = in.substr(0, sizes[i]);
+			in.remove_prefix(std::min(size_t(sizes[i]), in.size()));
+		}
+		if (!valid) break;
+
+		if (frame >= _frames.size()) {
+			_frames.resize(size_t(frame) + 1);
+			_archived.resize(size_t(frame) + 1, false);
+		}
+		_frames[frame] = std::move(archived);
+		_archived[frame] = true;
+		offset += _kChunkHeaderSize + chunkSize;
+	}
+	_validSize = offset;
+	return true;
+}
+
+void FrameArchiveWriter::open(const std::string &fileName, const bool resume)
+{
+	_fout.close();
+	_fileName = fileName;
+	size_t validSize = 0;
+	if (resume) {
+		FrameArchive archive;
+		if (archive.open(fileName)) validSize = archive._validSize;
+		else if (std::filesystem::exists(fileName) && std::filesystem::file_size(fileName) > 0) {
+			std::cerr << fmt::format("Error: [FrameArchiveWriter] {} is not a frame archive.", fileName) << std::endl;
+			std::exit(-1);
+		}
+	}
+	if (validSize > 0) {
+		if (std::filesystem::file_size(fileName) > validSize) std::filesystem::resize_file(fileName, validSize);
+		_fout.open(fileName, std::ios::binary | std::ios::app);
+	}
+	else {
+		_fout.open(fileName, std::ios::binary | std::ios::trunc);
+		IO::writeArray(_fout, FrameArchive::_kMagic, sizeof(FrameArchive::_kMagic));
+		IO::writeValue(_fout, FrameArchive::_kVersion);
+		_fout.flush();
+	}
+	if (!_fout) {
+		std::cerr << fmt::format("Error: [FrameArchiveWriter] failed to open {}.", fileName) << std::endl;
+		std::exit(-1);
+	}
+}
+
+void FrameArchiveWriter::append(const uint frame, const std::vector<std::pair<std::string_view, std::string_view>> &sections)
+{
+	// The chunk header and the table of sections are gathered, so that a chunk takes one write besides the sections.
+	std::ostringstream table(std::move(_chunkHeader), std::ios::binary);
+	table.seekp(0);
+	uint64_t chunkSize = 0;
+	for (const auto &[name, bytes] : sections)
+		chunkSize += sizeof(uint64_t) + sizeof(uint) + name.size() + bytes.size();
+	IO::writeValue(table, frame);
+	IO::writeValue(table, uint(sections.size()));
+	IO::writeValue(table, chunkSize);
+	for (const auto &[name, bytes] : sections) {
+		IO::writeValue(table, uint64_t(bytes.size()));
+		IO::writeValue(table, uint(name.size()));
+		IO::writeArray(table, name.data(), name.size());
+	}
+	_chunkHeader = std::move(table).str();
+	const size_t tableSize = FrameArchive::_kChunkHeaderSize + chunkSize - [&] {
+		uint64_t dataSize = 0;
+		for (const auto &section : sections) dataSize += section.second.size();
+		return dataSize;
+	}();
+
+	IO::writeArray(_fout, _chunkHeader.data(), tableSize);
+	for (const auto &section : sections)
+		IO::writeArray(_fout, section.second.data(), section.second.size());
+	_fout.flush();
+	if (!_fout || !syncFile(_fileName)) {
+		std::cerr << fmt::format("Error: [FrameArchiveWriter] failed to append frame {}.", frame) << std::endl;
+		std::exit(-1);
+	}
+}
+
+}
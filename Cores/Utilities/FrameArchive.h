@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Utilities/MappedFile.h"
+#include "Utilities/Types.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <cstdint>
+
+namespace PhysX {
+
+// An append-only container of frames in a single file.
+//
+// The file starts with a header of the magic and the version. Each frame is appended as a chunk, whose header gives
+// the frame, the number of sections and the byte size of the rest of the chunk. A table of sections, each of which is
+// the byte size and the name, is followed by the bytes of sections in the same order. A frame appended again
+// supersedes the former chunk, and a partially written chunk at the end is ignored by readers and dropped by writers.
+
+// Named sections of a frame, such as "particles.mesh", viewing the bytes of a mapped archive.
+class ArchivedFrame
+{
+	friend class FrameArchive;
+
+protected:
+
+	std::vector<std::pair<std::string_view, std::string_view>> _sections;
+
+public:
+
+	// Returns the bytes of the section, which are empty if it is missing.
+	std::string_view find(const std::string_view name) const;
+	// Returns a stream over a copy of the section, exiting if it is missing.
+	std::istringstream open(const std::string &name) const;
+};
+
+class FrameArchive
+{
+public:
+
+	static constexpr const char *kFileName = "frames.bin";
+
+protected:
+
+	static constexpr char _kMagic[8] = { 'V', 'C', 'L', 'F', 'R', 'A', 'M', 'E' };
+	static constexpr uint _kVersion = 1;
+	static constexpr size_t _kHeaderSize = sizeof(_kMagic) + sizeof(uint);
+	static constexpr size_t _kChunkHeaderSize = 2 * sizeof(uint) + sizeof(uint64_t);
+
+	friend class FrameArchiveWriter;
+
+	MappedFile _file;
+	std::vector<ArchivedFrame> _frames;
+	std::vector<bool> _archived;
+	size_t _validSize = 0;
+
+public:
+
+	FrameArchive() = default;
+	FrameArchive(const FrameArchive &rhs) = delete;
+	FrameArchive &operator=(const FrameArchive &rhs) = delete;
+	virtual ~FrameArchive() = default;
+
+	// Maps the file and indexes its chunks. Returns false if the file is missing or not an archive.
+	bool open(const std::string &fileName);
+
+	uint frameCount() const { return uint(_frames.size()); }
+	bool contains(const uint frame) const { return frame < _archived.size() && _archived[frame]; }
+	const ArchivedFrame &frame(const uint frame) const { return _frames[frame]; }
+};
+
+class FrameArchiveWriter
+{
+protected:
+
+	std::string _fileName;
+	std::ofstream _fout;
+	std::string _chunkHeader;
+
+public:
+
+	FrameArchiveWriter() = default;
+	FrameArchiveWriter(const FrameArchiveWriter &rhs) = delete;
+	FrameArchiveWriter &operator=(const FrameArchiveWriter &rhs) = delete;
+	virtual ~FrameArchiveWriter() = default;
+
+	// Opens the archive, which is emptied unless resuming. On resuming, a partially written chunk is dropped if any.
+	void open(const std::string &fileName, const bool resume);
+
+	// Appends a frame of (name, bytes) sections, and flushes it to the storage device.
+	void append(const uint frame, const std::vector<std::pair<std::string_view, std::string_view>> &sections);
+};
+
+}
@@ -2,8 +2,14 @@
 
 #include "Utilities/Types.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <cstring>
 
 namespace PhysX::IO {
 
@@ -16,6 +22,21 @@ inline void readValue(std::istream &in, Type &val) { read(in, &val, sizeof(Type)
 template <typename Type>
 inline void readArray(std::istream &in, Type *const data, const size_t cnt) { if (cnt > 0) read(in, data, sizeof(Type) * cnt); }
 
+// Reads from the front of in, which is advanced. Bytes beyond its end are left unread.
+template <typename Type>
+inline void read(std::string_view &in, Type *const data, const size_t cnt)
+{
+	const size_t size = std::min(cnt, in.size());
+	if (size > 0) std::memcpy(reinterpret_cast<char *>(data), in.data(), size);
+	in.remove_prefix(size);
+}
+
+template <typename Type>
+inline void readValue(std::string_view &in, Type &val) { read(in, &val, sizeof(Type)); }
+
+template <typename Type>
+inline void readArray(std::string_view &in, Type *const data, const size_t cnt) { if (cnt > 0) read(in, data, sizeof(Type) * cnt); }
+
 template <typename Type>
 inline void write(std::ostream &out, const Type *const data, const size_t cnt) { out.write(reinterpret_cast<const char *>(data), cnt); }
 
@@ -25,4 +46,24 @@ inline void writeValue(std::ostream &out, const Type &val) { write(out, &val, si
 template <typename Type>
 inline void writeArray(std::ostream &out, const Type *const data, const size_t cnt) { if (cnt > 0) write(out, data, sizeof(Type) * cnt); }
 
+// Converts cnt values given by func in parallel into a staging buffer, which is written by one call.
+template <typename Type, typename Func>
+inline void writeMapped(std::ostream &out, const size_t cnt, Func &&func)
+{
+	std::vector<Type> staging(cnt);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < int(cnt); i++) staging[i] = func(i);
+	writeArray(out, staging.data(), cnt);
+}
+
+// Writes an array of vectors, such as a particle attribute, with components cast to Scalar.
+template <typename Scalar, typename Array>
+inline void writeCast(std::ostream &out, const Array &arr)
+{
+	using Type = std::remove_cvref_t<decltype(arr[0].template cast<Scalar>().eval())>;
+	writeMapped<Type>(out, arr.size(), [&](const int i) { return arr[i].template cast<Scalar>(); });
+}
+
 }
@@ -0,0 +1,87 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace PhysX {
+
+bool MappedFile::open(const std::string &fileName)
+{
+	close();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	_file = file;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) { close(); return false; }
+	_size = size_t(size.QuadPart);
+	if (_size == 0) return true;
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!_mapping) { close(); return false; }
+	_data = static_cast<const char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!_data) { close(); return false; }
+#else
+	_file = ::open(fileName.c_str(), O_RDONLY);
+	if (_file < 0) return false;
+	struct stat status;
+	if (fstat(_file, &status) != 0) { close(); return false; }
+	_size = size_t(status.st_size);
+	if (_size == 0) return true;
+	void *data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _file, 0);
+	if (data == MAP_FAILED) { close(); return false; }
+	_data = static_cast<const char *>(data);
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+	if (_data) UnmapViewOfFile(_data);
+	if (_mapping) CloseHandle(_mapping);
+	if (_file) CloseHandle(_file);
+	_mapping = nullptr;
+	_file = nullptr;
+#else
+	if (_data) munmap(const_cast<char *>(_data), _size);
+	if (_file >= 0) ::close(_file);
+	_file = -1;
+#endif
+	_data = nullptr;
+	_size = 0;
+}
+
+bool MappedFile::isOpen() const
+{
+#ifdef _WIN32
+	return _file != nullptr;
+#else
+	return _file >= 0;
+#endif
+}
+
+bool syncFile(const std::string &fileName)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+	const bool synced = FlushFileBuffers(file);
+	CloseHandle(file);
+#else
+	const int file = ::open(fileName.c_str(), O_WRONLY);
+	if (file < 0) return false;
+	const bool synced = fsync(file) == 0;
+	::close(file);
+#endif
+	return synced;
+}
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace PhysX {
+
+// A read-only memory mapping of a whole file.
+class MappedFile
+{
+protected:
+
+	const char *_data = nullptr;
+	size_t _size = 0;
+#ifdef _WIN32
+	void *_file = nullptr;
+	void *_mapping = nullptr;
+#else
+	int _file = -1;
+#endif
+
+public:
+
+	MappedFile() = default;
+	MappedFile(const MappedFile &rhs) = delete;
+	MappedFile &operator=(const MappedFile &rhs) = delete;
+	virtual ~MappedFile() { close(); }
+
+	bool open(const std::string &fileName);
+	void close();
+
+	bool isOpen() const;
+	std::string_view bytes() const { return { _data, _size }; }
+};
+
+// Flushes the data of a file written through other handles, e.g., streams, to the storage device.
+bool syncFile(const std::string &fileName);
+
+}
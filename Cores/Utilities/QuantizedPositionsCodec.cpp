@@ -0,0 +1,179 @@
+#include "QuantizedPositionsCodec.h"
+
+#include "Utilities/IO.h"
+
+#include <fmt/core.h>
+
+namespace PhysX {
+
+QuantizedPositionsCodec::QuantizedPositionsCodec(const int dim, const Vector3f &lower, const Vector3f &upper, const float errorBound) :
+	_dim(dim),
+	_origin(lower),
+	_step(errorBound * 2)
+{
+	if (!(errorBound > 0)) reportError("non-positive error bound");
+	const float extent = (upper - lower).head(_dim).maxCoeff();
+	if (extent / _step > _kMaxLevel)
+		reportError(fmt::format("error bound {} too small for 16-bit positions in a domain of {}", errorBound, extent));
+}
+
+QuantizedPositionsCodec::QuantizedPositionsCodec(const int dim, const YAML::Node &node) :
+	_dim(dim)
+{
+	if (!node["quantization"]["origin"] || !node["quantization"]["step"]) reportError("missing quantization");
+	_origin = node["quantization"]["origin"].as<Vector3f>();
+	_step = node["quantization"]["step"].as<float>();
+}
+
+void QuantizedPositionsCodec::writeDescription(YAML::Node &node) const
+{
+	node["encoding"] = "quantized";
+	node["quantization"]["origin"] = _origin;
+	node["quantization"]["step"] = _step;
+}
+
+bool QuantizedPositionsCodec::isKeyFrame(std::string_view in)
+{
+	uint key = 0;
+	IO::readValue(in, key);
+	return key;
+}
+
+void QuantizedPositionsCodec::decode(std::string_view &in, const uint cnt, Vector3f *const positions)
+{
+	uint key;
+	IO::readValue(in, key);
+	const size_t valueCnt = size_t(cnt) * _dim;
+	if (!key && _last.size() != valueCnt) reportError("difference frame without its last frame");
+
+	const int blockCnt = int((cnt + _kBlockSize - 1) / _kBlockSize);
+	std::vector<uint> blockSizes(blockCnt);
+	IO::readArray(in, blockSizes.data(), blockCnt);
+	std::vector<size_t> blockOffsets(size_t(blockCnt) + 1, 0);
+	for (int b = 0; b < blockCnt; b++) blockOffsets[b + 1] = blockOffsets[b] + blockSizes[b];
+	if (blockOffsets.back() > in.size()) reportError("truncated positions");
+
+	_current.resize(valueCnt);
+	bool valid = true;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(&& : valid)
+#endif
+	for (int b = 0; b < blockCnt; b++) {
+		const size_t begin = b * _kBlockSize * _dim;
+		const size_t end = std::min(begin + _kBlockSize * _dim, valueCnt);
+		valid = decodeBlock(
+			in.substr(blockOffsets[b], blockSizes[b]),
+			key ? nullptr : _last.data() + begin,
+			_current.data() + begin,
+			end - begin) && valid;
+	}
+	if (!valid) reportError("corrupted positions");
+	in.remove_prefix(blockOffsets.back());
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int i = 0; i < int(cnt); i++) {
+		positions[i] = _origin;
+		for (int axis = 0; axis < _dim; axis++)
+			positions[i][axis] += _current[size_t(i) * _dim + axis] * _step;
+	}
+	_last.swap(_current);
+}
+
+void QuantizedPositionsCodec::writeCurrent(std::ostream &out)
+{
+	const bool key = _last.size() != _current.size() || _framesSinceKey + 1 >= _kKeyFrameInterval;
+	_framesSinceKey = key ? 0 : _framesSinceKey + 1;
+
+	const size_t valueCnt = _current.size();
+	const int blockCnt = int((valueCnt / _dim + _kBlockSize - 1) / _kBlockSize);
+	_blocks.resize(std::max(_blocks.size(), size_t(blockCnt)));
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int b = 0; b < blockCnt; b++) {
+		const size_t begin = b * _kBlockSize * _dim;
+		const size_t end = std::min(begin + _kBlockSize * _dim, valueCnt);
+		encodeBlock(key ? nullptr : _last.data() + begin, _current.data() + begin, end - begin, _blocks[b]);
+	}
+
+	IO::writeValue(out, uint(key));
+	for (int b = 0; b < blockCnt; b++) IO::writeValue(out, uint(_blocks[b].size()));
+	for (int b = 0; b < blockCnt; b++) IO::writeArray(out, _blocks[b].data(), _blocks[b].size());
+	_last.swap(_current);
+}
+
+// A control byte c below 128 is followed by c + 1 literal bytes, and otherwise stands for c - 127 zeros.
+
+void QuantizedPositionsCodec::encodeBlock(const ushort *const last, const ushort *const current, const size_t cnt, std::string &block)
+{
+	thread_local std::vector<uchar> planes;
+	planes.resize(cnt * 2);
+	for (size_t k = 0; k < cnt; k++) {
+		const short delta = short(ushort(current[k] - (last ? last[k] : 0)));
+		const ushort zigzag = ushort((delta << 1) ^ (delta >> 15));
+		planes[k] = uchar(zigzag);
+		planes[cnt + k] = uchar(zigzag >> 8);
+	}
+
+	block.clear();
+	const size_t size = planes.size();
+	size_t i = 0;
+	while (i < size) {
+		size_t zeros = 0;
+		while (i + zeros < size && !planes[i + zeros] && zeros < 128) zeros++;
+		if (zeros >= 2) {
+			block.push_back(char(127 + zeros));
+			i += zeros;
+			continue;
+		}
+		// Extend literals until a run of two zeros begins.
+		size_t len = 1;
+		while (i + len < size && len < 128 && (planes[i + len] || (i + len + 1 < size && planes[i + len + 1]))) len++;
+		block.push_back(char(len - 1));
+		block.append(reinterpret_cast<const char *>(planes.data() + i), len);
+		i += len;
+	}
+}
+
+bool QuantizedPositionsCodec::decodeBlock(std::string_view block, const ushort *const last, ushort *const current, const size_t cnt)
+{
+	thread_local std::vector<uchar> planes;
+	planes.resize(cnt * 2);
+	const size_t size = planes.size();
+	size_t i = 0;
+	while (!block.empty()) {
+		const uchar control = uchar(block.front());
+		block.remove_prefix(1);
+		if (control >= 128) {
+			const size_t zeros = control - 127;
+			if (i + zeros > size) return false;
+			std::fill_n(planes.begin() + i, zeros, uchar(0));
+			i += zeros;
+		}
+		else {
+			const size_t len = size_t(control) + 1;
+			if (i + len > size || len > block.size()) return false;
+			std::copy_n(block.begin(), len, planes.begin() + i);
+			block.remove_prefix(len);
+			i += len;
+		}
+	}
+	if (i != size) return false;
+
+	for (size_t k = 0; k < cnt; k++) {
+		const ushort zigzag = ushort(planes[k] | planes[cnt + k] << 8);
+		const ushort delta = ushort((zigzag >> 1) ^ -(zigzag & 1));
+		current[k] = ushort((last ? last[k] : 0) + delta);
+	}
+	return true;
+}
+
+void QuantizedPositionsCodec::reportError(const std::string &msg)
+{
+	std::cerr << fmt::format("Error: [QuantizedPositionsCodec] encountered {}.", msg) << std::endl;
+	std::exit(-1);
+}
+
+}
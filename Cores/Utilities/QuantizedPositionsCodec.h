@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Utilities/Types.h"
+#include "Utilities/Yaml.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cmath>
+
+namespace PhysX {
+
+// A compact encoding of positions in .mesh files, which objects opt into by "encoding: quantized" in the description.
+//
+// Components are quantized to 16-bit fixed point in a domain box, with steps of twice the error bound, and stored as
+// differences from the last frame, which are exact in modular arithmetic. A key frame is stored from zero instead
+// every _kKeyFrameInterval frames, and whenever the number of positions changes. Positions are coded in independent
+// blocks, in parallel: differences are zigzag mapped, split into a plane of low bytes and a plane of high bytes, and
+// runs of zeros, which particles at rest give, are run-length encoded.
+//
+// After the number of positions, the payload is a key frame flag, the byte sizes of blocks and then the blocks.
+// An instance keeps the last frame, so it either encodes or decodes frames of one object in order.
+class QuantizedPositionsCodec
+{
+protected:
+
+	static constexpr size_t _kBlockSize = 1 << 14; // positions per block
+	static constexpr uint _kKeyFrameInterval = 32;
+	static constexpr uint _kMaxLevel = 65535;
+
+	const int _dim;
+	Vector3f _origin;
+	float _step;
+
+	std::vector<ushort> _last;
+	std::vector<ushort> _current;
+	std::vector<std::string> _blocks;
+	uint _framesSinceKey = 0;
+
+public:
+
+	// For encoding positions in [lower, upper] with the given error bound.
+	QuantizedPositionsCodec(const int dim, const Vector3f &lower, const Vector3f &upper, const float errorBound);
+	// For decoding, with the quantization given by the description of an object.
+	QuantizedPositionsCodec(const int dim, const YAML::Node &node);
+
+	QuantizedPositionsCodec(const QuantizedPositionsCodec &rhs) = delete;
+	QuantizedPositionsCodec &operator=(const QuantizedPositionsCodec &rhs) = delete;
+	virtual ~QuantizedPositionsCodec() = default;
+
+	void writeDescription(YAML::Node &node) const;
+
+	// Writes the payload of positions, which are clamped to the domain box.
+	template <typename Array>
+	void encode(std::ostream &out, const Array &positions)
+	{
+		const int cnt = int(positions.size());
+		_current.resize(size_t(cnt) * _dim);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < cnt; i++) {
+			for (int axis = 0; axis < _dim; axis++) {
+				const double level = std::round((double(positions[i][axis]) - _origin[axis]) / _step);
+				_current[size_t(i) * _dim + axis] = ushort(std::clamp(level, 0.0, double(_kMaxLevel)));
+			}
+		}
+		writeCurrent(out);
+	}
+
+	// Returns whether the payload at the front of in is of a key frame.
+	static bool isKeyFrame(std::string_view in);
+	// Reads the payload of cnt positions from the front of in, which is advanced.
+	void decode(std::string_view &in, const uint cnt, Vector3f *const positions);
+
+protected:
+
+	void writeCurrent(std::ostream &out);
+
+	static void encodeBlock(const ushort *const last, const ushort *const current, const size_t cnt, std::string &block);
+	static bool decodeBlock(std::string_view block, const ushort *const last, ushort *const current, const size_t cnt);
+
+	static void reportError(const std::string &msg);
+};
+
+}
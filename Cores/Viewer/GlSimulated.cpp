@@ -4,17 +4,23 @@
 
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 
 #include <cstdlib>
 
 namespace PhysX {
-GlSimulated::GlSimulated(GlProgram *const program, const std::string &outputDir, const uint endFrame, const int dim, const YAML::Node &node) :
-	GlRenderItem(program)
+GlSimulated::GlSimulated(GlProgram *const program, const std::string &outputDir, const uint endFrame, const int dim, const YAML::Node &node, const bool streaming) :
+	GlRenderItem(program),
+	_outputDir(outputDir),
+	_dim(dim)
 {
 	// Read name.
 	if (!node["name"]) reportError("unnamed object");
-	const std::string name = node["name"].as<std::string>();
+	_meshName = node["name"].as<std::string>() + ".mesh";
+	_heatRangeName = node["name"].as<std::string>() + ".heat_range";
 
 	// Read data mode.
 	if (!node["data_mode"]) reportError("missing data mode");
@@ -30,13 +36,23 @@ GlSimulated::GlSimulated(GlProgram *const program, const std::string &outputDir,
 	if (node["indexed"]) _indexed = node["indexed"].as<bool>();
 	else _indexed = false;
 
+	// Read constant normal.
+	if (node["constant_normal"]) {
+		_constantNormal = true;
+		_normal = node["constant_normal"].as<Vector3f>();
+	}
+	else {
+		_constantNormal = false;
+		_normal = Vector3f::Unit(2);
+	}
+
 	// Read color map.
 	if (node["color_map"] && node["color_map"]["enabled"])
 		_enableColorMap = node["color_map"]["enabled"].as<bool>();
 	else _enableColorMap = false;
-	bool normalizedHeat = false;
 	if (node["color_map"] && node["color_map"]["normalized"])
-		normalizedHeat = node["color_map"]["normalized"].as<bool>();
+		_normalizedHeat = node["color_map"]["normalized"].as<bool>();
+	else _normalizedHeat = false;
 
 	// Read material.
 	_diffuseAlbedo = Vector4f(0.5f, 0.5f, 0.5f, 1.0f);
@@ -51,46 +67,86 @@ GlSimulated::GlSimulated(GlProgram *const program, const std::string &outputDir,
 			_roughness = node["material"]["roughness"].as<float>();
 	}
 
-	// Initialize meshes.
+	// Read encoding.
+	if (node["encoding"]) {
+		const std::string encoding = node["encoding"].as<std::string>();
+		if (encoding == "quantized") _codec = std::make_unique<QuantizedPositionsCodec>(dim, node);
+		else if (encoding != "float") reportError("invalid encoding");
+	}
+
+	// Open the frame archive, or read frame directories written before it.
+	_archived = _archive.open(_outputDir + "/" + FrameArchive::kFileName);
+	const auto meshOf = [&](const uint frame) {
+		const std::string_view bytes = findMesh(frame);
+		if (bytes.empty()) reportError(fmt::format("missing {} of frame {}", _meshName, frame));
+		return bytes;
+	};
+
+	// Set vertex formats.
+	glVertexArrayAttribBinding(_vao, 0, 0);
+	glVertexArrayAttribFormat(_vao, 0, 3, GL_FLOAT, GL_FALSE, 0);
+	glEnableVertexArrayAttrib(_vao, 0);
+	glVertexArrayAttribBinding(_vao, 1, 1);
+	glVertexArrayAttribFormat(_vao, 1, 3, GL_FLOAT, GL_FALSE, 0);
+	glEnableVertexArrayAttrib(_vao, 1);
+	if (_enableColorMap) {
+		glVertexArrayAttribBinding(_vao, 2, 2);
+		glVertexArrayAttribFormat(_vao, 2, 1, GL_FLOAT, GL_FALSE, 0);
+		glEnableVertexArrayAttrib(_vao, 2);
+	}
+
 	std::vector<Vector3f> positions;
 	std::vector<Vector3f> normals;
 	std::vector<float> heats;
 	std::vector<uint> indices;
+
+	if (streaming && dataMode != "static") {
+		if (dataMode == "semi-dynamic") {
+			// Indices are given by the first frame.
+			if (_indexed) {
+				loadMesh(meshOf(0), &positions, nullptr, nullptr, &indices);
+				_decodedFrame = 0;
+				_idxFrameOffset = { 0, uint(indices.size()) };
+				glCreateBuffers(1, &_ebo);
+				glNamedBufferStorage(_ebo, indices.size() * sizeof(indices[0]), indices.data(), 0);
+				glVertexArrayElementBuffer(_vao, _ebo);
+			}
+		}
+		else if (dataMode != "dynamic") reportError("invalid data mode");
+		_streamIndices = _indexed && dataMode == "dynamic";
+		_cache = std::make_unique<MeshFrameCache>(
+			[this](const uint frame, MeshFrame &mesh) { return loadFrame(frame, mesh); },
+			endFrame);
+		return;
+	}
+
+	// Initialize meshes.
+	const auto loadFrameMesh = [&](const uint frame, const bool withIndices) {
+		const size_t vtxBegin = positions.size();
+		const size_t idxBegin = indices.size();
+		loadMesh(meshOf(frame), &positions, &normals, _enableColorMap ? &heats : nullptr, withIndices ? &indices : nullptr);
+		_decodedFrame = frame;
+		if (_enableColorMap && !_normalizedHeat) {
+			Vector2f range;
+			if (!findHeatRange(frame, range)) range = computeHeatRange(heats.data() + vtxBegin, heats.size() - vtxBegin);
+			includeHeatRange(range);
+		}
+		_vtxFrameOffset.push_back(uint(positions.size() - vtxBegin));
+		if (withIndices) _idxFrameOffset.push_back(uint(indices.size() - idxBegin));
+	};
+	_vtxFrameOffset.push_back(0);
+	if (_indexed) _idxFrameOffset.push_back(0);
 	if (dataMode == "static") {
-		_vtxFrameOffset.push_back(0);
-		if (_indexed) _idxFrameOffset.push_back(0);
-		loadMesh(
-			fmt::format("{}/0/{}.mesh", outputDir, name),
-			dim,
-			&positions,
-			&normals,
-			_enableColorMap ? &heats : nullptr,
-			_indexed ? &indices : nullptr);
+		loadFrameMesh(0, _indexed);
 	}
 	else if (dataMode == "dynamic") {
-		_vtxFrameOffset.push_back(0);
-		if (_indexed) _idxFrameOffset.push_back(0);
 		for (uint frame = 0; frame < endFrame; frame++) {
-			loadMesh(
-				fmt::format("{}/{}/{}.mesh", outputDir, frame, name),
-				dim,
-				&positions,
-				&normals,
-				_enableColorMap ? &heats : nullptr,
-				_indexed ? &indices : nullptr);
+			loadFrameMesh(frame, _indexed);
 		}
 	}
 	else if (dataMode == "semi-dynamic") {
-		_vtxFrameOffset.push_back(0);
-		if (_indexed) _idxFrameOffset.push_back(0);
 		for (uint frame = 0; frame < endFrame; frame++) {
-			loadMesh(
-				fmt::format("{}/{}/{}.mesh", outputDir, frame, name),
-				dim,
-				&positions,
-				&normals,
-				_enableColorMap ? &heats : nullptr,
-				_indexed && !frame ? &indices : nullptr);
+			loadFrameMesh(frame, _indexed && !frame);
 		}
 	}
 	else reportError("invalid data mode");
@@ -104,38 +160,20 @@ GlSimulated::GlSimulated(GlProgram *const program, const std::string &outputDir,
 		}
 	}
 
-	// Normalized heats.
-	if (_enableColorMap && !normalizedHeat) {
-		const auto minmax = std::minmax_element(heats.begin(), heats.end());
-		float minimum = *minmax.first;
-		float maximum = *minmax.second;
-		if (minimum == maximum) minimum -= 1, maximum += 1;
-		for (auto &x : heats) x = (x - minimum) / (maximum - minimum);
-	}
-
 	// Create vertex buffers.
 	auto sizeBase = positions.size() * sizeof(float);
 	glCreateBuffers(1, &_vbo);
-	glNamedBufferData(_vbo, (_enableColorMap ? 7 : 6) * sizeBase, nullptr, GL_STATIC_DRAW);		
+	glNamedBufferData(_vbo, (_enableColorMap ? 7 : 6) * sizeBase, nullptr, GL_STATIC_DRAW);
 	// Attribute 0.
 	glNamedBufferSubData(_vbo, 0, 3 * sizeBase, positions.data());
 	glVertexArrayVertexBuffer(_vao, 0, _vbo, 0, 3 * sizeof(float));
-	glVertexArrayAttribBinding(_vao, 0, 0);
-	glVertexArrayAttribFormat(_vao, 0, 3, GL_FLOAT, GL_FALSE, 0);
-	glEnableVertexArrayAttrib(_vao, 0);
 	// Attribute 1.
 	glNamedBufferSubData(_vbo, 3 * sizeBase, 3 * sizeBase, normals.data());
 	glVertexArrayVertexBuffer(_vao, 1, _vbo, 3 * sizeBase, 3 * sizeof(float));
-	glVertexArrayAttribBinding(_vao, 1, 1);
-	glVertexArrayAttribFormat(_vao, 1, 3, GL_FLOAT, GL_FALSE, 0);
-	glEnableVertexArrayAttrib(_vao, 1);
 	// Attribute 2.
 	if (_enableColorMap) {
 		glNamedBufferSubData(_vbo, 6 * sizeBase, sizeBase, heats.data());
 		glVertexArrayVertexBuffer(_vao, 2, _vbo, 6 * sizeBase, sizeof(float));
-		glVertexArrayAttribBinding(_vao, 2, 2);
-		glVertexArrayAttribFormat(_vao, 2, 1, GL_FLOAT, GL_FALSE, 0);
-		glEnableVertexArrayAttrib(_vao, 2);
 	}
 
 	// Create index buffers.
@@ -146,10 +184,32 @@ GlSimulated::GlSimulated(GlProgram *const program, const std::string &outputDir,
 	}
 }
 
+GlSimulated::~GlSimulated()
+{
+	// Stop loading before the archive is unmapped.
+	_cache.reset();
+	for (const auto &buffer : _ring) {
+		glDeleteBuffers(1, &buffer.ebo);
+		glDeleteBuffers(1, &buffer.vbo);
+	}
+	glDeleteBuffers(1, &_ebo);
+	glDeleteBuffers(1, &_vbo);
+}
+
+void GlSimulated::setCurrentFrame(const uint frame, const uint endFrame)
+{
+	_currentFrame = frame;
+	if (_cache) {
+		_cache->setCursor(frame, endFrame);
+		updateHeatRange(endFrame);
+	}
+}
+
 void GlSimulated::beginDraw()
 {
 	// Set parameters according to current frame.
-	if (_indexed) {
+	if (_cache) streamCurrentFrame();
+	else if (_indexed) {
 		const size_t vtxFrame = _currentFrame < _vtxFrameOffset.size() - 1 ? _currentFrame : 0;
 		const size_t idxFrame = _currentFrame < _idxFrameOffset.size() - 1 ? _currentFrame : 0;
 		_count = _idxFrameOffset[idxFrame + 1] - _idxFrameOffset[idxFrame];
@@ -166,56 +226,210 @@ void GlSimulated::beginDraw()
 	_program->setUniform("uFresnelR0", _fresnelR0);
 	_program->setUniform("uRoughness", _roughness);
 	_program->setUniform("uEnableColorMap", uint(_enableColorMap));
+	// Heats are normalized by the range of all frames, which is widened if it is a single value.
+	Vector2f heatRange = _normalizedHeat || _heatRange[0] > _heatRange[1] ? Vector2f(0, 1) : _heatRange;
+	if (heatRange[0] == heatRange[1]) heatRange += Vector2f(-1, 1);
+	_program->setUniform("uHeatRange", heatRange);
+}
+
+void GlSimulated::streamCurrentFrame()
+{
+	int slot = -1;
+	for (int i = 0; i < _kRingSize; i++) {
+		if (_ring[i].frame == _currentFrame) slot = i;
+	}
+	if (slot < 0) {
+		if (const auto mesh = _cache->find(_currentFrame)) {
+			// Never overwrite the buffer drawn last, which the GPU may be still reading.
+			if (_nextSlot == _drawnSlot) _nextSlot = (_nextSlot + 1) % _kRingSize;
+			slot = _nextSlot;
+			_nextSlot = (_nextSlot + 1) % _kRingSize;
+			uploadMesh(*mesh, _ring[slot]);
+			_ring[slot].frame = _currentFrame;
+			if (_enableColorMap && !_normalizedHeat) includeHeatRange(mesh->heatRange);
+		}
+	}
+
+	// Keep drawing the last frame until the current one is loaded.
+	if (slot >= 0 && slot != _drawnSlot) {
+		const auto &buffer = _ring[slot];
+		const size_t sizeBase = buffer.vtxCapacity * sizeof(float);
+		glVertexArrayVertexBuffer(_vao, 0, buffer.vbo, 0, 3 * sizeof(float));
+		glVertexArrayVertexBuffer(_vao, 1, buffer.vbo, 3 * sizeBase, 3 * sizeof(float));
+		if (_enableColorMap) glVertexArrayVertexBuffer(_vao, 2, buffer.vbo, 6 * sizeBase, sizeof(float));
+		if (_streamIndices) glVertexArrayElementBuffer(_vao, buffer.ebo);
+		_drawnSlot = slot;
+	}
+	if (_drawnSlot < 0) {
+		_first = 0;
+		_count = 0;
+		return;
+	}
+
+	const auto &buffer = _ring[_drawnSlot];
+	if (_indexed) {
+		_count = _streamIndices ? buffer.idxCnt : _idxFrameOffset[1];
+		_indices = nullptr;
+		_baseVertex = 0;
+	}
+	else {
+		_first = 0;
+		_count = buffer.vtxCnt;
+	}
+}
+
+void GlSimulated::uploadMesh(const MeshFrame &mesh, StreamedBuffer &buffer) const
+{
+	const size_t vtxCnt = mesh.positions.size();
+	if (vtxCnt > buffer.vtxCapacity) {
+		// Grow geometrically, so that a growing number of particles rarely reallocates.
+		buffer.vtxCapacity = std::max(vtxCnt, buffer.vtxCapacity * 3 / 2);
+		if (!buffer.vbo) glCreateBuffers(1, &buffer.vbo);
+		glNamedBufferData(buffer.vbo, (_enableColorMap ? 7 : 6) * buffer.vtxCapacity * sizeof(float), nullptr, GL_STREAM_DRAW);
+	}
+	const size_t sizeBase = buffer.vtxCapacity * sizeof(float);
+	if (vtxCnt > 0) {
+		glNamedBufferSubData(buffer.vbo, 0, vtxCnt * sizeof(Vector3f), mesh.positions.data());
+		glNamedBufferSubData(buffer.vbo, 3 * sizeBase, vtxCnt * sizeof(Vector3f), mesh.normals.data());
+		if (_enableColorMap) glNamedBufferSubData(buffer.vbo, 6 * sizeBase, vtxCnt * sizeof(float), mesh.heats.data());
+	}
+	buffer.vtxCnt = uint(vtxCnt);
+
+	if (_streamIndices) {
+		const size_t idxCnt = mesh.indices.size();
+		if (idxCnt > buffer.idxCapacity) {
+			buffer.idxCapacity = std::max(idxCnt, buffer.idxCapacity * 3 / 2);
+			if (!buffer.ebo) glCreateBuffers(1, &buffer.ebo);
+			glNamedBufferData(buffer.ebo, buffer.idxCapacity * sizeof(uint), nullptr, GL_STREAM_DRAW);
+		}
+		if (idxCnt > 0) glNamedBufferSubData(buffer.ebo, 0, idxCnt * sizeof(uint), mesh.indices.data());
+		buffer.idxCnt = uint(idxCnt);
+	}
+}
+
+bool GlSimulated::loadFrame(const uint frame, MeshFrame &mesh)
+{
+	std::lock_guard lock(_archiveMutex);
+	std::string_view bytes = findMesh(frame);
+	if (bytes.empty()) return false;
+	if (_codec && frame != _decodedFrame + 1 && !isKeyFrame(bytes)) {
+		// Positions are stored as differences, so frames since the last key frame are decoded first.
+		uint keyFrame = frame - 1;
+		while (keyFrame > 0 && !isKeyFrame(findMesh(keyFrame))) keyFrame--;
+		std::vector<Vector3f> positions;
+		for (uint i = keyFrame; i < frame; i++) {
+			positions.clear();
+			loadMesh(findMesh(i), &positions, nullptr, nullptr, nullptr);
+		}
+		bytes = findMesh(frame);
+	}
+
+	mesh.positions.clear();
+	mesh.normals.clear();
+	mesh.heats.clear();
+	mesh.indices.clear();
+	loadMesh(bytes, &mesh.positions, &mesh.normals, _enableColorMap ? &mesh.heats : nullptr, _streamIndices ? &mesh.indices : nullptr);
+	_decodedFrame = frame;
+	// Frames written without ranges of heats extend the range as they are drawn.
+	if (_enableColorMap && !_normalizedHeat && !findHeatRange(frame, mesh.heatRange))
+		mesh.heatRange = computeHeatRange(mesh.heats.data(), mesh.heats.size());
+	return true;
+}
+
+std::string_view GlSimulated::findMesh(const uint frame)
+{
+	if (_archived) {
+		// The archive may have grown since it was mapped.
+		if (!_archive.contains(frame)) _archive.open(_outputDir + "/" + FrameArchive::kFileName);
+		return _archive.contains(frame) ? _archive.frame(frame).find(_meshName) : std::string_view();
+	}
+	std::ifstream fin(fmt::format("{}/{}/{}", _outputDir, frame, _meshName), std::ios::binary);
+	if (!fin) return {};
+	_fileBytes.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+	return _fileBytes;
+}
+
+bool GlSimulated::isKeyFrame(std::string_view bytes)
+{
+	uint vtxCnt;
+	IO::readValue(bytes, vtxCnt);
+	return QuantizedPositionsCodec::isKeyFrame(bytes);
+}
+
+bool GlSimulated::findHeatRange(const uint frame, Vector2f &range)
+{
+	if (!_archived || !_archive.contains(frame)) return false;
+	std::string_view bytes = _archive.frame(frame).find(_heatRangeName);
+	if (bytes.size() < 2 * sizeof(float)) return false;
+	IO::readArray(bytes, range.data(), 2);
+	return true;
+}
+
+void GlSimulated::updateHeatRange(const uint endFrame)
+{
+	if (!_archived || !_enableColorMap || _normalizedHeat || _rangedFrames >= endFrame) return;
+	// The archive is re-mapped by the loader when it grows, which is never waited for.
+	std::unique_lock lock(_archiveMutex, std::try_to_lock);
+	if (!lock) return;
+	for (; _rangedFrames < endFrame && _archive.contains(_rangedFrames); _rangedFrames++) {
+		Vector2f range;
+		if (findHeatRange(_rangedFrames, range)) includeHeatRange(range);
+	}
+}
+
+void GlSimulated::includeHeatRange(const Vector2f &range)
+{
+	_heatRange[0] = std::min(_heatRange[0], range[0]);
+	_heatRange[1] = std::max(_heatRange[1], range[1]);
 }
 
 void GlSimulated::loadMesh(
-	const std::string &fileName,
-	const int dim,
+	std::string_view bytes,
 	std::vector<Vector3f> *const positions,
 	std::vector<Vector3f> *const normals,
 	std::vector<float> *const heats,
 	std::vector<uint> *const indices)
 {
-	std::ifstream fin(fileName, std::ios::binary);
-	if (!fin) {
-		std::cerr << fmt::format("Error: [GlSimulated] failed to open {}.", fileName) << std::endl;
-		std::exit(-1);
-	}
+	// Bytes are consumed from the front.
 	uint vtxCnt;
-	IO::readValue(fin, vtxCnt);
-	_vtxFrameOffset.push_back(vtxCnt);
-	if (positions) {
-		positions->resize(positions->size() + vtxCnt, Vector3f::Zero().eval());
-		if (dim > 2)
-			IO::readArray(fin, positions->data() + positions->size() - vtxCnt, vtxCnt);
-		else {
-			for (uint i = 0; i < vtxCnt; i++) {
-				IO::read(fin, positions->data() + positions->size() - vtxCnt + i, sizeof(Vector2f));
-			}
+	IO::readValue(bytes, vtxCnt);
+	positions->resize(positions->size() + vtxCnt, Vector3f::Zero().eval());
+	if (_codec)
+		_codec->decode(bytes, vtxCnt, positions->data() + positions->size() - vtxCnt);
+	else if (_dim > 2)
+		IO::readArray(bytes, positions->data() + positions->size() - vtxCnt, vtxCnt);
+	else {
+		for (uint i = 0; i < vtxCnt; i++) {
+			IO::read(bytes, positions->data() + positions->size() - vtxCnt + i, sizeof(Vector2f));
 		}
 	}
 	if (normals) {
 		normals->resize(normals->size() + vtxCnt, Vector3f::Zero().eval());
-		if (dim > 2)
-			IO::readArray(fin, normals->data() + normals->size() - vtxCnt, vtxCnt);
-		else {
-			for (uint i = 0; i < vtxCnt; i++)
-				normals->operator[](normals->size() - vtxCnt + i).z() = 1.0f;
-		}
+		if (_dim > 2 && !_constantNormal)
+			IO::readArray(bytes, normals->data() + normals->size() - vtxCnt, vtxCnt);
+		else std::fill(normals->end() - vtxCnt, normals->end(), _normal);
 	}
+	else if (_dim > 2 && !_constantNormal) bytes.remove_prefix(std::min(vtxCnt * sizeof(Vector3f), bytes.size()));
 	if (heats) {
 		heats->resize(heats->size() + vtxCnt);
-		IO::readArray(fin, heats->data() + heats->size() - vtxCnt, vtxCnt);
+		IO::readArray(bytes, heats->data() + heats->size() - vtxCnt, vtxCnt);
 	}
+	else if (_enableColorMap) bytes.remove_prefix(std::min(vtxCnt * sizeof(float), bytes.size()));
 	if (indices) {
 		uint idxCnt;
-		IO::readValue(fin, idxCnt);
-		_idxFrameOffset.push_back(idxCnt);
+		IO::readValue(bytes, idxCnt);
 		indices->resize(indices->size() + idxCnt);
-		IO::readArray(fin, indices->data() + indices->size() - idxCnt, idxCnt);
+		IO::readArray(bytes, indices->data() + indices->size() - idxCnt, idxCnt);
 	}
 }
 
+Vector2f GlSimulated::computeHeatRange(const float *const heats, const size_t cnt)
+{
+	if (!cnt) return _kEmptyRange;
+	const auto minmax = std::minmax_element(heats, heats + cnt);
+	return Vector2f(*minmax.first, *minmax.second);
+}
+
 void GlSimulated::reportError(const std::string &msg) const
 {
 	std::cerr << fmt::format("Error: [GlSimulated] encountered {}.", msg) << std::endl;
@@ -1,9 +1,17 @@
 #pragma once
 
+#include "MeshFrameCache.h"
+
 #include "Graphics/GlRenderItem.h"
+#include "Utilities/FrameArchive.h"
+#include "Utilities/QuantizedPositionsCodec.h"
 #include "Utilities/Yaml.h"
 
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -21,46 +29,96 @@ public:
 
 protected:
 
-	GLuint _vbo;
-	GLuint _ebo;
+	static constexpr int _kRingSize = 3;
+	static constexpr uint _kNoFrame = ~uint(0);
+	static inline const Vector2f _kEmptyRange = Vector2f(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+
+	// A buffer of the ring of GPU buffers, which holds a streamed frame.
+	struct StreamedBuffer
+	{
+		GLuint vbo = 0;
+		GLuint ebo = 0;
+		size_t vtxCapacity = 0;
+		size_t idxCapacity = 0;
+		uint vtxCnt = 0;
+		uint idxCnt = 0;
+		uint frame = _kNoFrame;
+	};
+
+	GLuint _vbo = 0;
+	GLuint _ebo = 0;
+
+	const std::string _outputDir;
+	std::string _meshName;
+	std::string _heatRangeName;
+	const int _dim;
 
 	Vector4f _diffuseAlbedo;
 	Vector3f _fresnelR0;
 	float _roughness;
 	bool _enableColorMap;
+	bool _normalizedHeat;
+	// The range of heats of all frames, which are normalized in shaders. It is given by ranges written with frames,
+	// so it is known before frames are loaded, or else extended by frames as they are loaded.
+	Vector2f _heatRange = _kEmptyRange;
+	uint _rangedFrames = 0;
+	bool _constantNormal; // normals are not stored in mesh files, but given by the description
+	Vector3f _normal;
+	std::unique_ptr<QuantizedPositionsCodec> _codec; // decodes positions if quantized
+	uint _decodedFrame = _kNoFrame;
+
+	FrameArchive _archive;
+	bool _archived;
+	std::mutex _archiveMutex; // as frames are loaded in the background when streaming
+	std::string _fileBytes; // of a mesh read from a frame directory
 
 	uint _currentFrame = 0;
 
 	std::vector<uint> _vtxFrameOffset;
 	std::vector<uint> _idxFrameOffset;
 
+	// When streaming, frames around the current one are loaded in the background, and uploaded into a ring of
+	// GPU buffers when drawn. Otherwise all frames are loaded into one buffer.
+	bool _streamIndices = false;
+	StreamedBuffer _ring[_kRingSize];
+	int _nextSlot = 0;
+	int _drawnSlot = -1;
+	std::unique_ptr<MeshFrameCache> _cache;
+
 public:
 
-	GlSimulated(GlProgram *const program, const std::string &outputDir, const uint endFrame, const int dim, const YAML::Node &node);
+	// Meshes are viewed in the frame archive if any, or read from frame directories otherwise.
+	GlSimulated(GlProgram *const program, const std::string &outputDir, const uint endFrame, const int dim, const YAML::Node &node, const bool streaming);
 
 	GlSimulated(const GlSimulated &rhs) = delete;
 	GlSimulated &operator=(const GlSimulated &rhs) = delete;
-
-	virtual ~GlSimulated()
-	{
-		glDeleteBuffers(1, &_ebo);
-		glDeleteBuffers(1, &_vbo);
-	}
+	virtual ~GlSimulated();
 
 	virtual void beginDraw() override;
-	void setCurrentFrame(const uint frame) { _currentFrame = frame; }
+	void setCurrentFrame(const uint frame, const uint endFrame);
 	bool isTransparent() const { return _diffuseAlbedo.w() < 1.0f; }
 
 protected:
 
+	void streamCurrentFrame();
+	void uploadMesh(const MeshFrame &mesh, StreamedBuffer &buffer) const;
+	bool loadFrame(const uint frame, MeshFrame &mesh);
+	// Returns the bytes of the mesh of the frame, which are empty if the frame is not written yet.
+	std::string_view findMesh(const uint frame);
+	bool isKeyFrame(std::string_view bytes);
+	bool findHeatRange(const uint frame, Vector2f &range);
+	void updateHeatRange(const uint endFrame);
+	void includeHeatRange(const Vector2f &range);
+
 	void loadMesh(
-		const std::string &fileName,
-		const int dim,
+		std::string_view bytes,
 		std::vector<Vector3f> *const positions,
 		std::vector<Vector3f> *const normals,
 		std::vector<float> *const heats,
 		std::vector<uint> *const indices);
 
+	static Vector2f computeHeatRange(const float *const heats, const size_t cnt);
+
 	void reportError(const std::string &msg) const;
 };
 
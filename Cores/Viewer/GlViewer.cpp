@@ -5,9 +5,10 @@
 
 namespace PhysX {
 
-GlViewer::GlViewer(const std::string &outputDir, const uint frameRate) :
+GlViewer::GlViewer(const std::string &outputDir, const uint frameRate, const bool streaming) :
 	GlApp(1024, 768, "PhysX Viewer - " + outputDir),
 	_outputDir(outputDir),
+	_streaming(streaming),
 	_frameRate(frameRate)
 {
 	_this = this;
@@ -24,13 +25,10 @@ GlViewer::GlViewer(const std::string &outputDir, const uint frameRate) :
 			std::exit(-1);
 		}
 	}
-	{ // load end_frame.txt
-		std::ifstream fin(_outputDir + "/end_frame.txt");
-		if (!fin) {
-			std::cerr << fmt::format("Error: [GlViewer] failed to load {}/end_frame.txt.", _outputDir) << std::endl;
-			std::exit(-1);
-		}
-		fin >> _endFrame;
+	// Load end_frame.txt.
+	if (!readEndFrame()) {
+		std::cerr << fmt::format("Error: [GlViewer] failed to load {}/end_frame.txt.", _outputDir) << std::endl;
+		std::exit(-1);
 	}
 }
 
@@ -50,7 +48,7 @@ void GlViewer::buildRenderItems()
 	}
 
 	for (const auto &node : _root["objects"]) {
-		auto _simulated = std::make_unique<GlSimulated>(_programs["default"].get(), _outputDir, _endFrame, _dim, node);
+		auto _simulated = std::make_unique<GlSimulated>(_programs["default"].get(), _outputDir, _endFrame, _dim, node, _streaming);
 
 		// Push the item into vectors.
 		_ritemLayers[uint(_simulated->isTransparent() ? RenderLayer::Transparency : RenderLayer::Opaque)].push_back(_simulated.get());
@@ -61,6 +59,13 @@ void GlViewer::buildRenderItems()
 
 void GlViewer::update(const double dt)
 {
+	if (_streaming) {
+		_sinceEndFrameRead += dt;
+		if (_sinceEndFrameRead >= _kEndFrameReadInterval) {
+			_sinceEndFrameRead = 0;
+			readEndFrame();
+		}
+	}
 	if (_playing) {
 		_currentFrame += dt * _frameRate;
 		if (_currentFrame >= _endFrame - 1) {
@@ -69,7 +74,7 @@ void GlViewer::update(const double dt)
 		}
 	}
 	for (auto simulated : _simulatedObjects)
-		simulated->setCurrentFrame(uint(_currentFrame));
+		simulated->setCurrentFrame(uint(_currentFrame), _endFrame);
 	GlApp::update(dt);
 }
 
@@ -84,6 +89,15 @@ void GlViewer::updateText()
 		GlText::Alignment::Right);
 }
 
+bool GlViewer::readEndFrame()
+{
+	std::ifstream fin(_outputDir + "/end_frame.txt");
+	uint endFrame;
+	if (!(fin >> endFrame)) return false;
+	_endFrame = endFrame;
+	return true;
+}
+
 void GlViewer::keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods)
 {
 	if (action == GLFW_PRESS) {
@@ -19,9 +19,14 @@ protected:
 
 	static inline GlViewer *_this = nullptr;
 
+	static constexpr double _kEndFrameReadInterval = 0.5; // in seconds
+
 	const std::string _outputDir;
 	YAML::Node _root;
 
+	const bool _streaming; // frames keep coming while the simulator is running, so end_frame.txt is read again
+	double _sinceEndFrameRead = 0;
+
 	uint _endFrame;
 	uint _frameRate;
 
@@ -32,7 +37,7 @@ protected:
 
 public:
 
-	GlViewer(const std::string &outputDir, const uint frameRate);
+	GlViewer(const std::string &outputDir, const uint frameRate, const bool streaming);
 
 	GlViewer(const GlViewer &rhs) = delete;
 	GlViewer &operator=(const GlViewer &rhs) = delete;
@@ -46,6 +51,8 @@ protected:
 	virtual void update(const double dt) override;
 	virtual void updateText() override;
 
+	bool readEndFrame();
+
 	static void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
 };
 
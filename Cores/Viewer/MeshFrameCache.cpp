@@ -0,0 +1,115 @@
+#include "MeshFrameCache.h"
+
+#include <chrono>
+
+namespace PhysX {
+
+MeshFrameCache::MeshFrameCache(const Loader &loader, const uint endFrame) :
+	_loader(loader),
+	_endFrame(endFrame)
+{
+	_thread = std::thread(&MeshFrameCache::run, this);
+}
+
+MeshFrameCache::~MeshFrameCache()
+{
+	{
+		std::lock_guard lock(_mutex);
+		_stopping = true;
+	}
+	_cursorMoved.notify_one();
+	_thread.join();
+}
+
+void MeshFrameCache::setCursor(const uint cursor, const uint endFrame)
+{
+	{
+		std::lock_guard lock(_mutex);
+		if (cursor == _cursor && endFrame == _endFrame) return;
+		_cursor = cursor;
+		_endFrame = endFrame;
+	}
+	_cursorMoved.notify_one();
+}
+
+std::shared_ptr<const MeshFrame> MeshFrameCache::find(const uint frame)
+{
+	std::lock_guard lock(_mutex);
+	const auto iter = _frames.find(frame);
+	if (iter == _frames.end()) return nullptr;
+	touch(frame);
+	return iter->second.first;
+}
+
+void MeshFrameCache::run()
+{
+	using namespace std::chrono_literals;
+	std::unique_lock lock(_mutex);
+	while (true) {
+		uint frame;
+		_cursorMoved.wait(lock, [&] { return _stopping || nextFrameToLoad(frame); });
+		if (_stopping) break;
+		auto mesh = evictOrCreate();
+		lock.unlock();
+
+		const bool loaded = _loader(frame, *mesh);
+
+		lock.lock();
+		if (loaded) {
+			_recentFrames.push_front(frame);
+			_frames[frame] = { std::move(mesh), _recentFrames.begin() };
+		}
+		else {
+			// The frame may be still being written, so retry later.
+			_freeFrames.push_back(std::move(mesh));
+			_cursorMoved.wait_for(lock, 100ms);
+		}
+	}
+}
+
+bool MeshFrameCache::nextFrameToLoad(uint &frame) const
+{
+	for (uint i = 0; i < _kPrefetchAhead && _cursor + i < _endFrame; i++) {
+		if (!_frames.contains(_cursor + i)) {
+			frame = _cursor + i;
+			return true;
+		}
+	}
+	for (uint i = 1; i <= _kPrefetchBehind && i <= _cursor; i++) {
+		if (_cursor - i < _endFrame && !_frames.contains(_cursor - i)) {
+			frame = _cursor - i;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::shared_ptr<MeshFrame> MeshFrameCache::evictOrCreate()
+{
+	if (_frames.size() >= _kCapacity) {
+		// The capacity exceeds the prefetch window, so some frame out of the window is cached.
+		for (auto iter = _recentFrames.rbegin(); iter != _recentFrames.rend(); ++iter) {
+			const uint frame = *iter;
+			if (frame + _kPrefetchBehind >= _cursor && frame < _cursor + _kPrefetchAhead) continue;
+			auto mesh = std::move(_frames[frame].first);
+			_frames.erase(frame);
+			_recentFrames.erase(std::next(iter).base());
+			// Buffers are reused unless the frame is still being uploaded.
+			if (mesh.use_count() == 1) return mesh;
+			break;
+		}
+	}
+	if (!_freeFrames.empty()) {
+		auto mesh = std::move(_freeFrames.back());
+		_freeFrames.pop_back();
+		return mesh;
+	}
+	return std::make_shared<MeshFrame>();
+}
+
+void MeshFrameCache::touch(const uint frame)
+{
+	_recentFrames.splice(_recentFrames.begin(), _recentFrames, _frames[frame].second);
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Utilities/Types.h"
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace PhysX {
+
+// Vertices and indices of a mesh in a frame, staged in memory before they are uploaded.
+struct MeshFrame
+{
+	std::vector<Vector3f> positions;
+	std::vector<Vector3f> normals;
+	std::vector<float> heats;
+	std::vector<uint> indices;
+	Vector2f heatRange;
+};
+
+// Loads frames of a mesh around the playback cursor on a background thread, into an LRU cache of staging buffers.
+//
+// The loader prefers frames ahead of the cursor, and then a few behind it. At most _kCapacity frames are cached, and
+// the least recently used frame beyond the prefetch window is evicted for a new one, whose buffers are then reused.
+// Frames are handed out as shared pointers, so an evicted frame stays valid while it is being uploaded.
+class MeshFrameCache
+{
+public:
+
+	// Loads a frame into the buffers, returning false if the frame is not available yet.
+	using Loader = std::function<bool(const uint frame, MeshFrame &mesh)>;
+
+protected:
+
+	static constexpr uint _kCapacity = 48;
+	static constexpr uint _kPrefetchAhead = 32;
+	static constexpr uint _kPrefetchBehind = 4;
+
+	const Loader _loader;
+
+	std::list<uint> _recentFrames; // from the most recently used
+	std::unordered_map<uint, std::pair<std::shared_ptr<MeshFrame>, std::list<uint>::iterator>> _frames;
+	std::vector<std::shared_ptr<MeshFrame>> _freeFrames;
+
+	uint _cursor = 0;
+	uint _endFrame;
+	bool _stopping = false;
+
+	std::mutex _mutex;
+	std::condition_variable _cursorMoved;
+	std::thread _thread;
+
+public:
+
+	MeshFrameCache(const Loader &loader, const uint endFrame);
+
+	MeshFrameCache(const MeshFrameCache &rhs) = delete;
+	MeshFrameCache &operator=(const MeshFrameCache &rhs) = delete;
+	virtual ~MeshFrameCache();
+
+	void setCursor(const uint cursor, const uint endFrame);
+	// Returns the frame if it is cached, or nullptr otherwise.
+	std::shared_ptr<const MeshFrame> find(const uint frame);
+
+protected:
+
+	void run();
+	bool nextFrameToLoad(uint &frame) const;
+	std::shared_ptr<MeshFrame> evictOrCreate();
+	void touch(const uint frame);
+};
+
+}
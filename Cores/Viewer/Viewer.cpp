@@ -9,6 +9,7 @@ inline std::unique_ptr<ArgsParser> BuildArgsParser()
 	auto parser = std::make_unique<ArgsParser>();
 	parser->addArgument<std::string>("output", 'o', "the output directory", "output");
 	parser->addArgument<uint>("rate", 'r', "the frame rate (frames per second)", 50);
+	parser->addArgument<bool>("stream", 's', "stream frames around the current one instead of loading all", false);
 	return parser;
 }
 
@@ -19,8 +20,9 @@ int main(int argc, char *argv[])
 
 	const auto output = std::any_cast<std::string>(parser->getValueByName("output"));
 	const auto rate = std::any_cast<uint>(parser->getValueByName("rate"));
+	const auto stream = std::any_cast<bool>(parser->getValueByName("stream"));
 
-	auto glApp = std::make_unique<GlViewer>(output, rate);
+	auto glApp = std::make_unique<GlViewer>(output, rate, stream);
 	glApp->run();
 	return 0;
 }
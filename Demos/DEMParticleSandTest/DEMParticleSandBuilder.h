@@ -14,15 +14,15 @@ namespace PhysX {
     class DEMParticleSandBuilder final {
     public:
         template<int Dim>
-        static std::unique_ptr<DEMParticleSand<Dim>> build(const int scale, const int option) {
+        static std::unique_ptr<DEMParticleSand<Dim>> build(const int scale, const int option, const real quantize) {
             switch (option) {
-            case 0: return buildCase0<Dim>(scale);
+            case 0: return buildCase0<Dim>(scale, quantize);
             default: reportError("invalid option"); return nullptr;
             }
         }
 
     protected:
-        template<int Dim> static std::unique_ptr<DEMParticleSand<Dim>> buildCase0(int scale) {
+        template<int Dim> static std::unique_ptr<DEMParticleSand<Dim>> buildCase0(int scale, const real quantize) {
             DECLARE_DIM_TYPES(Dim)
             if (scale < 0) scale = 30;
             const real length = real(1);
@@ -53,6 +53,11 @@ namespace PhysX {
 
             sand->_boundary_velocity.resize(&sand->_boundary_particles);
 
+            // Boundary particles are generated in the box of half lengths 1.2 * length.
+            if (quantize > 0)
+                sand->enableQuantizedOutput(
+                    -VectorDr::Ones() * length * 1.2, VectorDr::Ones() * length * 1.2, quantize * radius);
+
             return sand;
         }
 
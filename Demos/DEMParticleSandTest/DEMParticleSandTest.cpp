@@ -18,6 +18,7 @@ inline std::unique_ptr<ArgsParser> BuildArgsParser()
 	parser->addArgument<uint>("rate", 'r', "the frame rate (frames per second)", 10000);
 	parser->addArgument<real>("cfl", 'c', "the CFL number", real(.4));
 	parser->addArgument<int>("scale", 's', "the scale of particles", -1);
+	parser->addArgument<real>("quantize", 'q', "the error bound of quantized positions relative to the particle radius, or 0 to write floats", real(0));
 	return parser;
 }
 
@@ -38,12 +39,13 @@ int main(int argc, char *argv[])
 	const auto rate = std::any_cast<uint>(parser->getValueByName("rate"));
 	const auto cfl = std::any_cast<real>(parser->getValueByName("cfl"));
 	const auto scale = std::any_cast<int>(parser->getValueByName("scale"));
+	const auto quantize = std::any_cast<real>(parser->getValueByName("quantize"));
 
 	std::unique_ptr<Simulation> sand;
 	if (dim == 2)
-		sand = DEMParticleSandBuilder::build<2>(scale, test);
+		sand = DEMParticleSandBuilder::build<2>(scale, test, quantize);
 	else if (dim == 3)
-		sand = DEMParticleSandBuilder::build<3>(scale, test);
+		sand = DEMParticleSandBuilder::build<3>(scale, test, quantize);
 	else {
 		std::cerr << "Error: [main] encountered invalid dimension." << std::endl;
 		std::exit(-1);
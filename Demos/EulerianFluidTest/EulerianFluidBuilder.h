@@ -8,6 +8,15 @@ namespace PhysX {
 
     class EulerianFluidBuilder final {
     public:
+        template<int Dim>
+        static std::unique_ptr<EulerianFluid<Dim>>
+        build(const int scale, const int option, const ProjectionSolver solver, const bool macCormack = false) {
+            auto fluid = build<Dim>(scale, option);
+            fluid->_projector->setSolver(solver);
+            if (macCormack) fluid->_advector = std::make_unique<MacCormackAdvector<Dim>>();
+            return fluid;
+        }
+
         template<int Dim>
         static std::unique_ptr<EulerianFluid<Dim>> build(const int scale, const int option) {
             switch (option) {
@@ -17,6 +17,8 @@ inline std::unique_ptr<ArgsParser> BuildArgsParser()
 	parser->addArgument<uint>("rate", 'r', "the frame rate (frames per second)", 50);
 	parser->addArgument<real>("cfl", 'c', "the CFL number", 1);
 	parser->addArgument<int>("scale", 's', "the scale of grid", -1);
+	parser->addArgument<int>("solver", 'l', "the linear solver of projection (0: CG, 1: ICPCG, 2: MICPCG)", 2);
+	parser->addArgument<bool>("maccormack", 'm', "advect by the MacCormack method with a limiter", false);
 	return parser;
 }
 
@@ -36,8 +38,10 @@ int main(int argc, char *argv[])
 	const auto rate = std::any_cast<uint>(parser->getValueByName("rate"));
 	const auto cfl = std::any_cast<real>(parser->getValueByName("cfl"));
 	const auto scale = std::any_cast<int>(parser->getValueByName("scale"));
+	const auto solver = ProjectionSolver(std::any_cast<int>(parser->getValueByName("solver")));
+	const auto macCormack = std::any_cast<bool>(parser->getValueByName("maccormack"));
 
-	auto fluid = EulerianFluidBuilder::build<2>(scale, test);
+	auto fluid = EulerianFluidBuilder::build<2>(scale, test, solver, macCormack);
 	auto simulator = std::make_unique<Simulator>(output, begin, end, rate, cfl, fluid.get());
 	simulator->Simulate();
 
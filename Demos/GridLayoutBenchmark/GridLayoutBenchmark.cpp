@@ -0,0 +1,131 @@
+#include "Structures/GridBasedScalarField.h"
+#include "Utilities/ArgsParser.h"
+
+#include <fmt/core.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <numbers>
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace PhysX;
+
+inline std::unique_ptr<ArgsParser> BuildArgsParser()
+{
+	auto parser = std::make_unique<ArgsParser>();
+	parser->addArgument<int>("dim", 'd', "the dimension of grids", 3);
+	parser->addArgument<int>("scale", 's', "the resolution of grids along each axis", 256);
+	parser->addArgument<int>("repeat", 'r', "the number of times each kernel is repeated", 3);
+	parser->addArgument<int>("threads", 'j', "the number of threads (0: all)", 1);
+	return parser;
+}
+
+// Sums in the order of data points rather than that of the storage, so checksums are identical across layouts.
+template <int Dim, typename Layout>
+real Checksum(const GridBasedScalarField<Dim, Layout> &field)
+{
+	real sum = 0;
+	field.forEach([&](const Vector<Dim, int> &coord) { sum += field[coord]; });
+	return sum;
+}
+
+// Times the kernels that dominate projection and advection on a scalar field stored in the given layout.
+template <int Dim, typename Layout>
+void Benchmark(const char *name, const Grid<Dim> &grid, const int repeat)
+{
+	DECLARE_DIM_TYPES(Dim)
+	using namespace std::chrono;
+
+	GridBasedScalarField<Dim, Layout> field(&grid);
+	field.parallelForEach([&](const VectorDi &coord) {
+		const VectorDr pos = field.position(coord);
+		field[coord] = std::sin(real(2) * std::numbers::pi_v<real> * pos.sum());
+	});
+	GridBasedScalarField<Dim, Layout> result(&grid);
+
+	// Laplacian at interior data points, the stencil of the pressure Poisson equation.
+	auto begin = steady_clock::now();
+	for (int k = 0; k < repeat; k++) {
+		field.parallelForEach([&](const VectorDi &coord) {
+			if (field.isInside(coord, 1)) result[coord] = field.laplacianAtDataPoint(coord);
+		});
+	}
+	const double laplacianTime = duration<double>(steady_clock::now() - begin).count();
+	const real laplacianSum = Checksum(result);
+
+	// Semi-Lagrangian sampling at departure points of a rotation, in batches as the advectors do.
+	constexpr int kBatchSize = 64;
+	const VectorDr center = grid.dataOrigin() + (grid.dataSize() - VectorDi::Ones()).template cast<real>() * grid.spacing() / 2;
+	const int cnt = int(grid.dataCount());
+	begin = steady_clock::now();
+	for (int k = 0; k < repeat; k++) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int first = 0; first < cnt; first += kBatchSize) {
+			const int batchCnt = std::min(cnt - first, kBatchSize);
+			std::array<VectorDr, kBatchSize> positions;
+			std::array<real, kBatchSize> values;
+			for (int i = 0; i < batchCnt; i++) {
+				const VectorDr pos = grid.dataPosition(grid.coordinate(first + i));
+				VectorDr vel = VectorDr::Zero();
+				vel[0] = -(pos[1] - center[1]), vel[1] = pos[0] - center[0];
+				positions[i] = pos - vel * grid.spacing();
+			}
+			field.interpolate(positions.data(), values.data(), batchCnt);
+			for (int i = 0; i < batchCnt; i++)
+				result[grid.coordinate(first + i)] = values[i];
+		}
+	}
+	const double advectionTime = duration<double>(steady_clock::now() - begin).count();
+	const real advectionSum = Checksum(result);
+
+	fmt::print("{:<8} laplacian {:8.3f}s (checksum {:.6e})  advection {:8.3f}s (checksum {:.6e})\n",
+		name, laplacianTime, laplacianSum, advectionTime, advectionSum);
+}
+
+template <int Dim>
+void Benchmark(const int scale, const int repeat)
+{
+	DECLARE_DIM_TYPES(Dim)
+
+	const Grid<Dim> grid(real(1) / scale, VectorDi::Ones() * scale, VectorDr::Zero());
+	fmt::print("{}^{} data points, {} repetitions\n", scale, Dim, repeat);
+	Benchmark<Dim, LinearGridLayout<Dim>>("linear", grid, repeat);
+	Benchmark<Dim, TiledGridLayout<Dim>>("tiled-4", grid, repeat);
+	if constexpr (Dim == 3) Benchmark<Dim, TiledGridLayout<Dim, 3>>("tiled-8", grid, repeat);
+}
+
+int main(int argc, char *argv[])
+{
+	auto parser = BuildArgsParser();
+	parser->parse(argc, argv);
+
+	const auto dim = std::any_cast<int>(parser->getValueByName("dim"));
+	const auto scale = std::any_cast<int>(parser->getValueByName("scale"));
+	const auto repeat = std::any_cast<int>(parser->getValueByName("repeat"));
+
+#ifdef _OPENMP
+	const auto threads = std::any_cast<int>(parser->getValueByName("threads"));
+	omp_set_num_threads(threads > 0 ? threads : omp_get_num_procs());
+#endif
+
+	if (dim == 2)
+		Benchmark<2>(scale, repeat);
+	else if (dim == 3)
+		Benchmark<3>(scale, repeat);
+	else {
+		std::cerr << "Error: [main] encountered invalid dimension." << std::endl;
+		std::exit(-1);
+	}
+
+	return 0;
+}
@@ -8,6 +8,22 @@ namespace PhysX {
 
     class LevelSetLiquidBuilder final {
     public:
+        template<int Dim>
+        static std::unique_ptr<LevelSetLiquid<Dim>>
+        build(const int scale, const int option, const ProjectionSolver solver, const bool narrowBand = false,
+              const bool fastIterative = false, const bool macCormack = false) {
+            auto liquid = build<Dim>(scale, option);
+            liquid->_projector->setSolver(solver);
+            if (macCormack) liquid->_advector = std::make_unique<MacCormackAdvector<Dim>>();
+            if (fastIterative)
+                liquid->_levelSetReinitializer =
+                    std::make_unique<FastIterativeReinitializer<Dim>>(liquid->_grid.cellGrid());
+            if (narrowBand)
+                liquid->_narrowBandLevelSet = std::make_unique<NarrowBandLevelSet<Dim>>(
+                    liquid->_grid.cellGrid(), LevelSetLiquid<Dim>::_kLsReinitMaxSteps);
+            return liquid;
+        }
+
         template<int Dim>
         static std::unique_ptr<LevelSetLiquid<Dim>> build(const int scale, const int option) {
             switch (option) {
@@ -23,6 +39,8 @@ namespace PhysX {
                 return buildCase4<Dim>(scale);
             case 5:
                 return buildCase5<Dim>(scale);
+            case 6:
+                return buildCase6<Dim>(scale);
             default:
                 reportError("invalid option");
                 return nullptr;
@@ -132,6 +150,36 @@ namespace PhysX {
             return liquid;
         }
 
+        template<int Dim>
+        static std::unique_ptr<LevelSetLiquid<Dim>> buildCase6(int scale) {
+            DECLARE_DIM_TYPES(Dim)
+            if (scale < 0) scale = 200;
+            const real         length     = real(2);
+            const VectorDi     resolution = scale * VectorDi::Ones();
+            StaggeredGrid<Dim> grid(2, length / scale, resolution);
+            auto               liquid = std::make_unique<LevelSetLiquid<Dim>>(grid);
+
+            ImplicitPlane<Dim> plane(VectorDr::Unit(1) * length / 8, VectorDr::Unit(1));
+            liquid->_levelSet.unionSurface(plane);
+            liquid->_levelSet.intersectSurface(ImplicitBox<Dim>(grid.domainOrigin(), grid.domainLengths()));
+
+            // A paddle spinning about the center of the pool.
+            VectorDr paddleLengths = VectorDr::Ones() * length / 4;
+            paddleLengths.x()      = length / 2;
+            paddleLengths.y()      = length / 16;
+            const real angularVelocity = real(2);
+            liquid->_colliders.push_back(std::make_unique<DynamicCollider<Dim>>(
+                std::make_unique<ImplicitBox<Dim>>(-paddleLengths / 2, paddleLengths),
+                -paddleLengths / 2,
+                paddleLengths,
+                [=](const real time, MatrixDr & rotation, VectorDr & translation) {
+                    if constexpr (Dim == 2) rotation = Eigen::Rotation2D<real>(angularVelocity * time).toRotationMatrix();
+                    else rotation = Eigen::AngleAxis<real>(angularVelocity * time, VectorDr::UnitZ()).toRotationMatrix();
+                    translation = -VectorDr::Unit(1) * length / 8;
+                }));
+            return liquid;
+        }
+
         static void reportError(const std::string & msg) {
             std::cerr << "Error: [LevelSetLiquidBuilder] encountered " << msg << ".\n"
                       << msg << std::endl;
@@ -18,6 +18,10 @@ inline std::unique_ptr<ArgsParser> BuildArgsParser()
 	parser->addArgument<uint>("rate", 'r', "the frame rate (frames per second)", 50);
 	parser->addArgument<real>("cfl", 'c', "the CFL number", 1);
 	parser->addArgument<int>("scale", 's', "the scale of grid", -1);
+	parser->addArgument<int>("solver", 'l', "the linear solver of projection (0: CG, 1: ICPCG, 2: MICPCG)", 2);
+	parser->addArgument<bool>("narrowband", 'w', "store the level set in a narrow band", false);
+	parser->addArgument<bool>("fim", 'i', "reinitialize the level set by the fast iterative method", false);
+	parser->addArgument<bool>("maccormack", 'm', "advect by the MacCormack method with a limiter", false);
 	return parser;
 }
 
@@ -38,12 +42,16 @@ int main(int argc, char *argv[])
 	const auto rate = std::any_cast<uint>(parser->getValueByName("rate"));
 	const auto cfl = std::any_cast<real>(parser->getValueByName("cfl"));
 	const auto scale = std::any_cast<int>(parser->getValueByName("scale"));
+	const auto solver = ProjectionSolver(std::any_cast<int>(parser->getValueByName("solver")));
+	const auto narrowBand = std::any_cast<bool>(parser->getValueByName("narrowband"));
+	const auto fim = std::any_cast<bool>(parser->getValueByName("fim"));
+	const auto macCormack = std::any_cast<bool>(parser->getValueByName("maccormack"));
 
 	std::unique_ptr<Simulation> liquid;
 	if (dim == 2)
-		liquid = LevelSetLiquidBuilder::build<2>(scale, test);
+		liquid = LevelSetLiquidBuilder::build<2>(scale, test, solver, narrowBand, fim, macCormack);
 	else if (dim == 3)
-		liquid = LevelSetLiquidBuilder::build<3>(scale, test);
+		liquid = LevelSetLiquidBuilder::build<3>(scale, test, solver, narrowBand, fim, macCormack);
 	else {
 		std::cerr << "Error: [main] encountered invalid dimension." << std::endl;
 		std::exit(-1);
@@ -6,10 +6,36 @@
 
 #include <fmt/core.h>
 
+#include <algorithm>
+
 namespace PhysX {
 
     class ParticleInCellLiquidBuilder final {
     public:
+        template<int Dim>
+        static std::unique_ptr<ParticleInCellLiquid<Dim>> build(
+            const int scale, const int option, const int nppsc, const real alpha, const ProjectionSolver solver,
+            const bool narrowBand = false, const bool fastIterative = false, const int populationInterval = 0,
+            const int flipBandCells = 0) {
+            auto liquid = build<Dim>(scale, option, nppsc, alpha);
+            liquid->_projector->setSolver(solver);
+            liquid->_populationControlInterval = populationInterval;
+            if (flipBandCells > 0) {
+                auto flipLiquid = dynamic_cast<FlImplicitParticleLiquid<Dim> *>(liquid.get());
+                if (!flipLiquid || flipBandCells < 2) reportError("invalid particle band of FLIP");
+                flipLiquid->_particlesBandWidth = flipBandCells * liquid->_grid.spacing();
+            }
+            if (fastIterative)
+                liquid->_levelSetReinitializer =
+                    std::make_unique<FastIterativeReinitializer<Dim>>(liquid->_grid.cellGrid());
+            // The band also holds the advected level set beneath the particles of narrow-band FLIP, and reaches a cell
+            // deeper than them, since distances are clamped to its width.
+            if (narrowBand)
+                liquid->_narrowBandLevelSet = std::make_unique<NarrowBandLevelSet<Dim>>(
+                    liquid->_grid.cellGrid(), std::max(ParticleInCellLiquid<Dim>::_kLsReinitMaxSteps, flipBandCells + 1));
+            return liquid;
+        }
+
         template<int Dim>
         static std::unique_ptr<ParticleInCellLiquid<Dim>> build(const int scale, const int option, const int nppsc, const real alpha) {
             switch (option) {
@@ -20,6 +20,11 @@ inline std::unique_ptr<ArgsParser> BuildArgsParser()
 	parser->addArgument<int>("scale", 's', "the scale of grid", -1);
 	parser->addArgument<int>("nppsc", 'n', "the number of particles per sub-cell", 2);
 	parser->addArgument<real>("alpha", 'a', "-1: APIC; [0, 1): FLIP; 1: PIC", 0);
+	parser->addArgument<int>("solver", 'l', "the linear solver of projection (0: CG, 1: ICPCG, 2: MICPCG)", 2);
+	parser->addArgument<bool>("narrowband", 'w', "store the level set in a narrow band", false);
+	parser->addArgument<bool>("fim", 'i', "reinitialize the level set by the fast iterative method", false);
+	parser->addArgument<int>("population", 'p', "the interval in steps of particle population control (0: never)", 0);
+	parser->addArgument<int>("flipband", 'f', "the width in cells of the particle band of FLIP (0: the entire liquid)", 0);
 	return parser;
 }
 
@@ -42,12 +47,17 @@ int main(int argc, char *argv[])
 	const auto scale = std::any_cast<int>(parser->getValueByName("scale"));
 	const auto nppsc = std::any_cast<int>(parser->getValueByName("nppsc"));
 	const auto alpha = std::any_cast<real>(parser->getValueByName("alpha"));
+	const auto solver = ProjectionSolver(std::any_cast<int>(parser->getValueByName("solver")));
+	const auto narrowBand = std::any_cast<bool>(parser->getValueByName("narrowband"));
+	const auto fim = std::any_cast<bool>(parser->getValueByName("fim"));
+	const auto population = std::any_cast<int>(parser->getValueByName("population"));
+	const auto flipBand = std::any_cast<int>(parser->getValueByName("flipband"));
 
 	std::unique_ptr<Simulation> liquid;
 	if (dim == 2)
-		liquid = ParticleInCellLiquidBuilder::build<2>(scale, test, nppsc, alpha);
+		liquid = ParticleInCellLiquidBuilder::build<2>(scale, test, nppsc, alpha, solver, narrowBand, fim, population, flipBand);
 	else if (dim == 3)
-		liquid = ParticleInCellLiquidBuilder::build<3>(scale, test, nppsc, alpha);
+		liquid = ParticleInCellLiquidBuilder::build<3>(scale, test, nppsc, alpha, solver, narrowBand, fim, population, flipBand);
 	else {
 		std::cerr << "Error: [main] encountered invalid dimension." << std::endl;
 		std::exit(-1);
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Geometries/ImplicitSurface.h"
+#include "Physics/DivFreeSphLiquid.h"
 #include "Physics/DualParticleSphLiquid.h"
+#include "Physics/ImplicitIncomprSphLiquid.h"
 #include "Physics/PredCorrIncomprSphLiquid.h"
 #include "Physics/SmthParticleHydrodLiquid.h"
 #include "Physics/WeakCompSphLiquid.h"
@@ -17,15 +19,33 @@ namespace PhysX {
     class SmthPartHydrodLiquidBuilder final {
     public:
         template<int Dim>
-        static std::unique_ptr<SmthParticleHydrodLiquid<Dim>> build(const int scale, const int option, const bool pci) {
+        static std::unique_ptr<SmthParticleHydrodLiquid<Dim>>
+            build(
+                const int  scale,
+                const int  option,
+                const bool pci,
+                const bool divFree    = false,
+                const bool implicit   = false,
+                const bool dual       = false,
+                const bool printStats = false) {
+            std::unique_ptr<SmthParticleHydrodLiquid<Dim>> liquid;
             switch (option) {
-            case 0: return buildCase0<Dim>(scale, pci);
+            case 0: liquid = buildCase0<Dim>(scale, pci, divFree, implicit, dual); break;
+            case 1: liquid = buildCase1<Dim>(scale, pci, divFree, implicit, dual); break;
             default: reportError("invalid option"); return nullptr;
             }
+            if (printStats) {
+                auto dualLiquid = dynamic_cast<DualParticleSphLiquid<Dim> *>(liquid.get());
+                if (!dualLiquid) reportError("projection statistics without virtual particles");
+                dualLiquid->_printsProjectionStats = true;
+            }
+            return liquid;
         }
 
     protected:
-        template<int Dim> static std::unique_ptr<SmthParticleHydrodLiquid<Dim>> buildCase0(int scale, const bool pci) {
+        template<int Dim>
+        static std::unique_ptr<SmthParticleHydrodLiquid<Dim>>
+            buildCase0(int scale, const bool pci, const bool divFree, const bool implicit, const bool dual) {
             DECLARE_DIM_TYPES(Dim)
             if (scale < 0) scale = 30;
             const real length = real(2);
@@ -34,7 +54,7 @@ namespace PhysX {
             StaggeredGrid<Dim> grid(2, length / scale / 2, resolution);
             const real         density = 1000;
             const real         radius  = length / 2 / scale / 2;
-            auto               liquid  = makeLiquid<Dim>(grid, radius, pci);
+            auto               liquid  = makeLiquid<Dim>(grid, radius, pci, divFree, implicit, dual);
             auto               shape   = Shapes<Dim>(radius);
             const real         omega   = 2.;
             shape.generateBox(VectorDr::Zero(), VectorDr::Ones() * length / 6, true);
@@ -53,8 +73,44 @@ namespace PhysX {
 
         template<int Dim>
         static std::unique_ptr<SmthParticleHydrodLiquid<Dim>>
-            makeLiquid(const StaggeredGrid<Dim> & grid, const real radius, const bool pci) {
-            if (pci) return std::make_unique<PredCorrIncomprSphLiquid<Dim>>(radius);
+            buildCase1(int scale, const bool pci, const bool divFree, const bool implicit, const bool dual) {
+            DECLARE_DIM_TYPES(Dim)
+            if (scale < 0) scale = 30;
+            const real length = real(2);
+
+            const VectorDi     resolution = 3 * scale * VectorDi::Ones();
+            StaggeredGrid<Dim> grid(2, length / scale / 2, resolution);
+            const real         density = 1000;
+            const real         radius  = length / 2 / scale / 2;
+            auto               liquid  = makeLiquid<Dim>(grid, radius, pci, divFree, implicit, dual);
+            auto               shape   = Shapes<Dim>(radius);
+            // A dam break in the corner of the container.
+            shape.generateBox(-VectorDr::Ones() * length / 4, VectorDr::Ones() * length / 4 - VectorDr::Ones() * radius);
+            liquid->addShape(shape);
+            liquid->_particles.setMass(density / liquid->_particles.getPackedKernelSum());
+            liquid->_targetDensity = density;
+            liquid->_enableGravity = true;
+
+            liquid->_colliders.push_back(
+                std::make_unique<StaticCollider<Dim>>(std::make_unique<ComplementarySurface<Dim>>(
+                    std::make_unique<ImplicitBox<Dim>>(-length / 2 * VectorDr::Ones(), length * VectorDr::Ones()))));
+
+            return liquid;
+        }
+
+        template<int Dim>
+        static std::unique_ptr<SmthParticleHydrodLiquid<Dim>>
+            makeLiquid(
+                const StaggeredGrid<Dim> & grid,
+                const real                 radius,
+                const bool                 pci,
+                const bool                 divFree,
+                const bool                 implicit,
+                const bool                 dual) {
+            if (dual) return std::make_unique<DualParticleSphLiquid<Dim>>(grid, radius);
+            else if (implicit) return std::make_unique<ImplicitIncomprSphLiquid<Dim>>(radius);
+            else if (divFree) return std::make_unique<DivFreeSphLiquid<Dim>>(radius);
+            else if (pci) return std::make_unique<PredCorrIncomprSphLiquid<Dim>>(radius);
             else return std::make_unique<WeakCompSphLiquid<Dim>>(radius);
         }
 
@@ -19,6 +19,10 @@ inline std::unique_ptr<ArgsParser> BuildArgsParser()
 	parser->addArgument<real>("cfl", 'c', "the CFL number", real(.4));
 	parser->addArgument<int>("scale", 's', "the scale of particles", -1);
 	parser->addArgument<bool>("pci", 'p', "enable prediction-correction", false);
+	parser->addArgument<bool>("dfsph", 'f', "enable divergence-free SPH", false);
+	parser->addArgument<bool>("iisph", 'i', "enable implicit incompressible SPH", false);
+	parser->addArgument<bool>("dual", 'u', "enable dual particle SPH with virtual particles", false);
+	parser->addArgument<bool>("stats", 'v', "print statistics of the virtual-particle projection in each step", false);
 	return parser;
 }
 
@@ -40,12 +44,16 @@ int main(int argc, char *argv[])
 	const auto cfl = std::any_cast<real>(parser->getValueByName("cfl"));
 	const auto scale = std::any_cast<int>(parser->getValueByName("scale"));
 	const auto pci = std::any_cast<bool>(parser->getValueByName("pci"));
+	const auto dfsph = std::any_cast<bool>(parser->getValueByName("dfsph"));
+	const auto iisph = std::any_cast<bool>(parser->getValueByName("iisph"));
+	const auto dual = std::any_cast<bool>(parser->getValueByName("dual"));
+	const auto stats = std::any_cast<bool>(parser->getValueByName("stats"));
 
 	std::unique_ptr<Simulation> liquid;
 	if (dim == 2)
-		liquid = SmthPartHydrodLiquidBuilder::build<2>(scale, test, pci);
+		liquid = SmthPartHydrodLiquidBuilder::build<2>(scale, test, pci, dfsph, iisph, dual, stats);
 	else if (dim == 3)
-		liquid = SmthPartHydrodLiquidBuilder::build<3>(scale, test, pci);
+		liquid = SmthPartHydrodLiquidBuilder::build<3>(scale, test, pci, dfsph, iisph, dual, stats);
 	else {
 		std::cerr << "Error: [main] encountered invalid dimension." << std::endl;
 		std::exit(-1);
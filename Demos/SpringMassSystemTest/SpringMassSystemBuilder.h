@@ -12,18 +12,24 @@ namespace PhysX {
     class SpringMassSystemBuilder final {
     public:
         template<int Dim>
-        static std::unique_ptr<SpringMassSystem<Dim>> build(const int option) {
+        static std::unique_ptr<SpringMassSystem<Dim>> build(const int option, const bool projective = false) {
+            std::unique_ptr<SpringMassSystem<Dim>> smSystem;
             switch (option) {
             case 0:
-                return buildCase0<Dim>();
+                smSystem = buildCase0<Dim>();
+                break;
             case 1:
-                return buildCase1<Dim>();
+                smSystem = buildCase1<Dim>();
+                break;
             case 2:
-                return buildCase2<Dim>();
+                smSystem = buildCase2<Dim>();
+                break;
             default:
                 reportError("invalid option");
                 return nullptr;
             }
+            if (projective) smSystem->_integrator = std::make_unique<SmsProjectiveDynamicsIntegrator<Dim>>();
+            return smSystem;
         }
 
     protected:
@@ -17,6 +17,7 @@ inline std::unique_ptr<ArgsParser> BuildArgsParser()
 	parser->addArgument<uint>("end", 'e', "the end frame (excluding)", 200);
 	parser->addArgument<uint>("rate", 'r', "the frame rate (frames per second)", 50);
 	parser->addArgument<real>("step", 's', "the number of steps per frame", 1);
+	parser->addArgument<bool>("projective", 'p', "integrate by projective dynamics", false);
 	return parser;
 }
 
@@ -36,12 +37,13 @@ int main(int argc, char *argv[])
 	const auto end = std::any_cast<uint>(parser->getValueByName("end"));
 	const auto rate = std::any_cast<uint>(parser->getValueByName("rate"));
 	const auto step = std::any_cast<real>(parser->getValueByName("step"));
+	const auto projective = std::any_cast<bool>(parser->getValueByName("projective"));
 
 	std::unique_ptr<Simulation> smSystem;
 	if (dim == 2)
-		smSystem = SpringMassSystemBuilder::build<2>(test);
+		smSystem = SpringMassSystemBuilder::build<2>(test, projective);
 	else if (dim == 3)
-		smSystem = SpringMassSystemBuilder::build<3>(test);
+		smSystem = SpringMassSystemBuilder::build<3>(test, projective);
 	else {
 		std::cerr << "Error: [main] encountered invalid dimension." << std::endl;
 		std::exit(-1);
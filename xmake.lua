@@ -105,4 +105,15 @@ target("examples")
     add_deps(unpack(examples))
 target_end()
 
+-- Usage: xmake b GridLayoutBenchmark && xmake r GridLayoutBenchmark -s 256
+target("GridLayoutBenchmark")
+    set_default(false)
+    set_kind("binary")
+    add_options("common")
+    add_options("openmp")
+    add_packages(unpack(pkgs))
+    add_deps("vcl-physx")
+    add_files("Demos/GridLayoutBenchmark/*.cpp")
+target_end()
+
 includes("Develop")